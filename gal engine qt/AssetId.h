@@ -0,0 +1,6 @@
+#pragma once
+
+// Compact handle for an interned asset path, see ResourceManager::assetId().
+// Ids are dense indices, so per-asset state can live in plain arrays.
+using AssetId = int;
+constexpr AssetId INVALID_ASSET = -1;
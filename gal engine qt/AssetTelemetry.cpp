@@ -0,0 +1,280 @@
+#include "AssetTelemetry.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+
+namespace {
+    thread_local int advanceDepth = 0;
+    thread_local int stallDepth = 0;
+
+    double ms(qint64 ns) { return ns / 1e6; }
+
+    QString csvField(QString s) {
+        if (!s.contains(',') && !s.contains('"')) return s;
+        return QString("\"%1\"").arg(s.replace('"', "\"\""));
+    }
+}
+
+void AssetTelemetry::setEnabled(bool enabled) {
+    m_enabled = enabled;
+}
+
+bool AssetTelemetry::isEnabled() const {
+    return m_enabled;
+}
+
+AssetTelemetry::Record& AssetTelemetry::slot(AssetId id) {
+    if (id >= m_records.size()) m_records.resize(id + 1);
+    return m_records[id];
+}
+
+void AssetTelemetry::touch(const Use& use, Record& r) {
+    if (r.firstUseMs >= 0) return;
+    r.firstUseMs = m_clock.elapsed();
+    m_order.append(use);
+}
+
+void AssetTelemetry::recordHit(AssetId id) {
+    if (!m_enabled || id == INVALID_ASSET) return;
+    QMutexLocker lock(&m_mutex);
+    ++slot(id).hits;
+}
+
+void AssetTelemetry::recordMiss(AssetId id) {
+    if (!m_enabled || id == INVALID_ASSET) return;
+    QMutexLocker lock(&m_mutex);
+    ++slot(id).misses;
+}
+
+void AssetTelemetry::recordRead(AssetId id, qint64 ns, qint64 bytes) {
+    if (!m_enabled || id == INVALID_ASSET) return;
+    QMutexLocker lock(&m_mutex);
+    Record& r = slot(id);
+    touch({ id, QString() }, r);
+    ++r.reads;
+    r.readNs += ns;
+    r.readBytes += bytes;
+}
+
+void AssetTelemetry::recordRead(const QString& path, qint64 ns, qint64 bytes) {
+    if (!m_enabled || path.isEmpty()) return;
+    QMutexLocker lock(&m_mutex);
+    Record& r = m_paths[path];
+    touch({ INVALID_ASSET, path }, r);
+    ++r.reads;
+    r.readNs += ns;
+    r.readBytes += bytes;
+}
+
+void AssetTelemetry::recordDecode(AssetId id, qint64 ns, qint64 bytes) {
+    if (!m_enabled || id == INVALID_ASSET) return;
+    QMutexLocker lock(&m_mutex);
+    Record& r = slot(id);
+    ++r.decodes;
+    r.decodeNs += ns;
+    r.decodedBytes += bytes;
+}
+
+void AssetTelemetry::recordStall(AssetId id, qint64 ns) {
+    if (!m_enabled || id == INVALID_ASSET) return;
+    QMutexLocker lock(&m_mutex);
+    Record& r = slot(id);
+    ++r.stalls;
+    r.stallNs += ns;
+    r.maxStallNs = qMax(r.maxStallNs, ns);
+}
+
+void AssetTelemetry::recordStall(const QString& path, qint64 ns) {
+    if (!m_enabled || path.isEmpty()) return;
+    QMutexLocker lock(&m_mutex);
+    Record& r = m_paths[path];
+    ++r.stalls;
+    r.stallNs += ns;
+    r.maxStallNs = qMax(r.maxStallNs, ns);
+}
+
+void AssetTelemetry::recordOpen(AssetId id) {
+    if (!m_enabled || id == INVALID_ASSET) return;
+    QMutexLocker lock(&m_mutex);
+    Record& r = slot(id);
+    touch({ id, QString() }, r);
+    ++r.opens;
+}
+
+AssetTelemetry::Record AssetTelemetry::record(AssetId id) const {
+    QMutexLocker lock(&m_mutex);
+    if (id < 0 || id >= m_records.size()) return Record();
+    return m_records.at(id);
+}
+
+AssetTelemetry::Record AssetTelemetry::total() const {
+    QMutexLocker lock(&m_mutex);
+    Record t;
+    auto add = [&t](const Record& r) {
+        t.hits += r.hits;
+        t.misses += r.misses;
+        t.opens += r.opens;
+        t.reads += r.reads;
+        t.readNs += r.readNs;
+        t.readBytes += r.readBytes;
+        t.decodes += r.decodes;
+        t.decodeNs += r.decodeNs;
+        t.decodedBytes += r.decodedBytes;
+        t.stalls += r.stalls;
+        t.stallNs += r.stallNs;
+        t.maxStallNs = qMax(t.maxStallNs, r.maxStallNs);
+    };
+    for (const Record& r : m_records) add(r);
+    for (const Record& r : m_paths) add(r);
+    return t;
+}
+
+QVector<QPair<AssetId, AssetTelemetry::Record>> AssetTelemetry::snapshot() const {
+    QMutexLocker lock(&m_mutex);
+    QVector<QPair<AssetId, Record>> out;
+    for (AssetId id = 0; id < m_records.size(); ++id) {
+        if (!m_records.at(id).isEmpty()) out.append({ id, m_records.at(id) });
+    }
+    return out;
+}
+
+void AssetTelemetry::reset() {
+    QMutexLocker lock(&m_mutex);
+    m_records.clear();
+    m_paths.clear();
+    m_order.clear();
+}
+
+QVector<QPair<QString, qint64>> AssetTelemetry::accessOrder(const NameFn& name) const {
+    QVector<Use> order;
+    QVector<qint64> times;
+    {
+        QMutexLocker lock(&m_mutex);
+        order = m_order;
+        for (const Use& use : std::as_const(order)) {
+            times.append(use.id != INVALID_ASSET ? m_records.at(use.id).firstUseMs : m_paths.value(use.path).firstUseMs);
+        }
+    }
+
+    // names are looked up outside the lock; `name` may take its own
+    QVector<QPair<QString, qint64>> out;
+    out.reserve(order.size());
+    for (int i = 0; i < order.size(); ++i) {
+        const Use& use = order.at(i);
+        const QString n = use.id == INVALID_ASSET ? use.path : name ? name(use.id) : QString::number(use.id);
+        out.append({ n, times.at(i) });
+    }
+    return out;
+}
+
+bool AssetTelemetry::dump(const QString& filename, const NameFn& name) const {
+    QFile f(filename);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    const bool json = filename.endsWith(".json", Qt::CaseInsensitive);
+    return f.write(json ? toJson(name) : toCsv(name)) >= 0;
+}
+
+QVector<QPair<QString, AssetTelemetry::Record>> AssetTelemetry::rows(const NameFn& name) const {
+    QVector<QPair<QString, Record>> out;
+    for (const auto& [id, r] : snapshot()) out.append({ name ? name(id) : QString::number(id), r });
+    {
+        QMutexLocker lock(&m_mutex);
+        for (auto it = m_paths.cbegin(); it != m_paths.cend(); ++it) out.append({ it.key(), it.value() });
+    }
+    std::sort(out.begin(), out.end(), [](const auto& a, const auto& b) {
+        if (a.second.stallNs != b.second.stallNs) return a.second.stallNs > b.second.stallNs;
+        return a.second.readNs + a.second.decodeNs > b.second.readNs + b.second.decodeNs;
+    });
+    return out;
+}
+
+QByteArray AssetTelemetry::toCsv(const NameFn& name) const {
+    QString out = "asset,hits,misses,hit_ratio,opens,reads,read_ms,read_bytes,"
+        "decodes,decode_ms,decoded_bytes,stalls,stall_ms,max_stall_ms,first_use_ms\n";
+    for (const auto& [asset, r] : rows(name)) {
+        out += csvField(asset);
+        out += QString(",%1,%2,%3,%4").arg(r.hits).arg(r.misses).arg(r.hitRatio(), 0, 'f', 3).arg(r.opens);
+        out += QString(",%1,%2,%3,%4,%5,%6")
+            .arg(r.reads).arg(ms(r.readNs), 0, 'f', 3).arg(r.readBytes)
+            .arg(r.decodes).arg(ms(r.decodeNs), 0, 'f', 3).arg(r.decodedBytes);
+        out += QString(",%1,%2,%3,%4\n")
+            .arg(r.stalls).arg(ms(r.stallNs), 0, 'f', 3).arg(ms(r.maxStallNs), 0, 'f', 3).arg(r.firstUseMs);
+    }
+    return out.toUtf8();
+}
+
+QByteArray AssetTelemetry::toJson(const NameFn& name) const {
+    QJsonArray assets;
+    for (const auto& [asset, r] : rows(name)) {
+        QJsonObject o;
+        o["asset"] = asset;
+        o["hits"] = double(r.hits);
+        o["misses"] = double(r.misses);
+        o["hitRatio"] = r.hitRatio();
+        o["opens"] = double(r.opens);
+        o["reads"] = double(r.reads);
+        o["readMs"] = ms(r.readNs);
+        o["readBytes"] = double(r.readBytes);
+        o["decodes"] = double(r.decodes);
+        o["decodeMs"] = ms(r.decodeNs);
+        o["decodedBytes"] = double(r.decodedBytes);
+        o["stalls"] = double(r.stalls);
+        o["stallMs"] = ms(r.stallNs);
+        o["maxStallMs"] = ms(r.maxStallNs);
+        o["firstUseMs"] = double(r.firstUseMs);
+        assets.append(o);
+    }
+
+    const Record t = total();
+    QJsonObject totals;
+    totals["hits"] = double(t.hits);
+    totals["misses"] = double(t.misses);
+    totals["hitRatio"] = t.hitRatio();
+    totals["readMs"] = ms(t.readNs);
+    totals["readBytes"] = double(t.readBytes);
+    totals["decodeMs"] = ms(t.decodeNs);
+    totals["decodedBytes"] = double(t.decodedBytes);
+    totals["stalls"] = double(t.stalls);
+    totals["stallMs"] = ms(t.stallNs);
+    totals["maxStallMs"] = ms(t.maxStallNs);
+
+    QJsonObject root;
+    root["totals"] = totals;
+    root["assets"] = assets;
+    return QJsonDocument(root).toJson(QJsonDocument::Indented);
+}
+
+AssetTelemetry::AdvanceScope::AdvanceScope() {
+    ++advanceDepth;
+}
+
+AssetTelemetry::AdvanceScope::~AdvanceScope() {
+    --advanceDepth;
+}
+
+bool AssetTelemetry::inAdvance() {
+    return advanceDepth > 0;
+}
+
+AssetTelemetry::StallTimer::StallTimer(AssetTelemetry& telemetry, AssetId id) : m_id(id) {
+    start(telemetry);
+}
+
+AssetTelemetry::StallTimer::StallTimer(AssetTelemetry& telemetry, const QString& path) : m_path(path) {
+    start(telemetry);
+}
+
+void AssetTelemetry::StallTimer::start(AssetTelemetry& telemetry) {
+    if (stallDepth++ > 0 || !inAdvance() || !telemetry.isEnabled()) return;
+    m_telemetry = &telemetry;
+    m_timer.start();
+}
+
+AssetTelemetry::StallTimer::~StallTimer() {
+    --stallDepth;
+    if (!m_telemetry) return;
+    if (m_id != INVALID_ASSET) m_telemetry->recordStall(m_id, m_timer.nsecsElapsed());
+    else m_telemetry->recordStall(m_path, m_timer.nsecsElapsed());
+}
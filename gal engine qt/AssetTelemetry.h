@@ -0,0 +1,124 @@
+#pragma once
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QPair>
+#include <QElapsedTimer>
+#include <atomic>
+#include <functional>
+#include "AssetId.h"
+
+// Per-asset access counters, for finding the assets behind frame hitches and
+// tuning preload lists / cache budgets. ResourceManager records:
+//   - reads: raw bytes fetched (pak entry, I/O cache, VFS) and the time taken
+//   - decodes: image decode time and decoded bytes, worker or GUI thread
+//   - hits / misses: pixmap cache lookups
+//   - stalls: synchronous loads on the GUI thread while ScriptEngine::advance()
+//     is running, i.e. time the player sees as a hitch
+//   - first use: when the asset was first read or opened, which orders the
+//     access trace the packer lays packages out by
+// Thread-safe; indexed by AssetId, so a record costs one short lock. Files
+// read by path without an AssetId (scripts, saves, screenshots) are kept by
+// path instead, so recording never interns anything.
+class AssetTelemetry {
+public:
+    struct Record {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 opens = 0; // streams
+        quint64 reads = 0;
+        qint64 readNs = 0;
+        qint64 readBytes = 0;
+        quint64 decodes = 0;
+        qint64 decodeNs = 0;
+        qint64 decodedBytes = 0;
+        quint64 stalls = 0;
+        qint64 stallNs = 0;
+        qint64 maxStallNs = 0;
+        qint64 firstUseMs = -1; // since the telemetry was created
+
+        bool isEmpty() const { return hits == 0 && misses == 0 && opens == 0 && reads == 0 && decodes == 0 && firstUseMs < 0; }
+        double hitRatio() const { return hits + misses ? double(hits) / double(hits + misses) : 0.0; }
+    };
+
+    using NameFn = std::function<QString(AssetId id)>;
+
+    AssetTelemetry() { m_clock.start(); }
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+
+    void recordHit(AssetId id);
+    void recordMiss(AssetId id);
+    void recordRead(AssetId id, qint64 ns, qint64 bytes);
+    void recordDecode(AssetId id, qint64 ns, qint64 bytes);
+    void recordStall(AssetId id, qint64 ns);
+    // Stream opened; the reads happen elsewhere (PakEntryDevice, QFile).
+    void recordOpen(AssetId id);
+    // By path, for files that have no AssetId.
+    void recordRead(const QString& path, qint64 ns, qint64 bytes);
+    void recordStall(const QString& path, qint64 ns);
+
+    Record record(AssetId id) const;
+    Record total() const;
+    // Every asset with at least one recorded access, by id; no path records.
+    QVector<QPair<AssetId, Record>> snapshot() const;
+    void reset();
+    // Assets and paths by first use, with its time in ms.
+    QVector<QPair<QString, qint64>> accessOrder(const NameFn& name) const;
+
+    // Format follows the extension: .json, anything else is CSV.
+    // Rows are sorted by stall time, then read + decode time.
+    bool dump(const QString& filename, const NameFn& name) const;
+    QByteArray toCsv(const NameFn& name) const;
+    QByteArray toJson(const NameFn& name) const;
+
+    // Marks the current thread as inside ScriptEngine::advance(); nests.
+    class AdvanceScope {
+    public:
+        AdvanceScope();
+        ~AdvanceScope();
+        AdvanceScope(const AdvanceScope&) = delete;
+        AdvanceScope& operator=(const AdvanceScope&) = delete;
+    };
+    static bool inAdvance();
+
+    // Times a blocking load. Counts as a stall of `id` only when it runs
+    // inside advance() and is the outermost timer on the thread, so a
+    // synchronous getPixmap() is not counted again by the getData() below it.
+    class StallTimer {
+    public:
+        StallTimer(AssetTelemetry& telemetry, AssetId id);
+        StallTimer(AssetTelemetry& telemetry, const QString& path);
+        ~StallTimer();
+        StallTimer(const StallTimer&) = delete;
+        StallTimer& operator=(const StallTimer&) = delete;
+
+    private:
+        void start(AssetTelemetry& telemetry);
+
+        AssetTelemetry* m_telemetry = nullptr; // null when not timing
+        AssetId m_id = INVALID_ASSET;
+        QString m_path; // when m_id is invalid
+        QElapsedTimer m_timer;
+    };
+
+private:
+    struct Use {
+        AssetId id;
+        QString path; // when id is invalid
+    };
+
+    Record& slot(AssetId id); // m_mutex held
+    void touch(const Use& use, Record& r); // m_mutex held
+    // Asset and path records, named, worst offenders first.
+    QVector<QPair<QString, Record>> rows(const NameFn& name) const;
+
+    mutable QMutex m_mutex;
+    QVector<Record> m_records;
+    QHash<QString, Record> m_paths;
+    QVector<Use> m_order; // first use
+    QElapsedTimer m_clock;
+    std::atomic<bool> m_enabled{ true };
+};
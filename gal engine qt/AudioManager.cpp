@@ -2,7 +2,8 @@
 #include "ResourceManager.h"
 #include <QUrl>
 #include <QDebug>
-#include <QBuffer>
+#include <QFileInfo>
+#include <QElapsedTimer>
 
 AudioManager::AudioManager(QObject* parent) : QObject(parent) {
     m_bgm = new QMediaPlayer(this);
@@ -27,6 +28,33 @@ AudioManager::AudioManager(QObject* parent) : QObject(parent) {
     });
 }
 
+// ϵļֱӽĿ PakEntryDevice ȡԤνѹ
+bool AudioManager::setSource(QMediaPlayer* player, const QString& file) {
+    ResourceManager& rm = ResourceManager::instance();
+    QIODevice* previous = player->sourceDevice();
+
+    const QString local = rm.localFilePath(file);
+    if (!local.isEmpty()) {
+        // ļɲԼȡ´Сʹ򿪺ʱ advance() еʱΪ
+        const AssetId id = rm.recordAudioOpen(file);
+        AssetTelemetry::StallTimer stall(rm.telemetry(), id);
+        QElapsedTimer timer;
+        timer.start();
+        player->setSource(QUrl::fromLocalFile(local));
+        rm.telemetry().recordRead(id, timer.nsecsElapsed(), QFileInfo(local).size());
+    }
+    else {
+        rm.registerAudio(file);
+        QIODevice* device = rm.openStream(file, player);
+        if (!device) return false;
+        // URL ֻʾʽ
+        player->setSourceDevice(device, QUrl(file));
+    }
+
+    if (previous) previous->deleteLater();
+    return true;
+}
+
 void AudioManager::setBgmVolume(float v) {
     if (m_bgmOut) m_bgmOut->setVolume(qBound(0.0f, v, 1.0f));
 }
@@ -36,19 +64,9 @@ void AudioManager::playBgm(const QString& file) {
     if (m_currentBgm == file && m_bgm->playbackState() == QMediaPlayer::PlayingState) return;
     m_currentBgm = file;
 
-    if (ResourceManager::USE_PACKED_RESOURCES) {
-        QByteArray data = ResourceManager::instance().getData(file);
-        if (data.isEmpty()) {
-            qDebug() << "BGM not found in resources:" << file;
-            return;
-        }
-        QBuffer* buffer = new QBuffer(m_bgm);
-        buffer->setData(data);
-        buffer->open(QIODevice::ReadOnly);
-        m_bgm->setSourceDevice(buffer);
-    }
-    else {
-        m_bgm->setSource(QUrl::fromLocalFile(file));
+    if (!setSource(m_bgm, file)) {
+        qDebug() << "BGM not found in resources:" << file;
+        return;
     }
 
     m_bgm->setLoops(QMediaPlayer::Infinite);
@@ -70,19 +88,9 @@ void AudioManager::playSe(const QString& file) {
     if (file.isEmpty()) return;
     if (m_se->playbackState() == QMediaPlayer::PlayingState) m_se->stop();
 
-    if (ResourceManager::USE_PACKED_RESOURCES) {
-        QByteArray data = ResourceManager::instance().getData(file);
-        if (data.isEmpty()) {
-            qDebug() << "SE not found in resources:" << file;
-            return;
-        }
-        QBuffer* buffer = new QBuffer(m_se);
-        buffer->setData(data);
-        buffer->open(QIODevice::ReadOnly);
-        m_se->setSourceDevice(buffer);
-    }
-    else {
-        m_se->setSource(QUrl::fromLocalFile(file));
+    if (!setSource(m_se, file)) {
+        qDebug() << "SE not found in resources:" << file;
+        return;
     }
 
     m_se->setLoops(1);
@@ -97,19 +105,9 @@ void AudioManager::playSeWithCallback(const QString& file, std::function<void()>
         m_seCallbacks.append(callback);
     }
 
-    if (ResourceManager::USE_PACKED_RESOURCES) {
-        QByteArray data = ResourceManager::instance().getData(file);
-        if (data.isEmpty()) {
-            qDebug() << "SE not found in resources:" << file;
-            return;
-        }
-        QBuffer* buffer = new QBuffer(m_se);
-        buffer->setData(data);
-        buffer->open(QIODevice::ReadOnly);
-        m_se->setSourceDevice(buffer);
-    }
-    else {
-        m_se->setSource(QUrl::fromLocalFile(file));
+    if (!setSource(m_se, file)) {
+        qDebug() << "SE not found in resources:" << file;
+        return;
     }
 
     m_se->setLoops(1);
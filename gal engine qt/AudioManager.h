@@ -26,6 +26,8 @@ signals:
     void seFinished();
 
 private:
+    bool setSource(QMediaPlayer* player, const QString& file);
+
     QMediaPlayer* m_bgm;
     QAudioOutput* m_bgmOut;
     QString m_currentBgm;
@@ -0,0 +1,102 @@
+#include "Crc32c.h"
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define CRC32C_X86 1
+#include <nmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#if defined(CRC32C_X86) && (defined(__GNUC__) || defined(__clang__))
+#define CRC32C_TARGET_SSE42 __attribute__((target("sse4.2")))
+#else
+#define CRC32C_TARGET_SSE42
+#endif
+
+namespace {
+    constexpr quint32 POLY = 0x82F63B78; // reflected Castagnoli polynomial
+
+    struct Tables {
+        quint32 t[8][256];
+        Tables() {
+            for (quint32 i = 0; i < 256; ++i) {
+                quint32 c = i;
+                for (int k = 0; k < 8; ++k) c = (c >> 1) ^ (POLY & (0u - (c & 1)));
+                t[0][i] = c;
+            }
+            for (quint32 i = 0; i < 256; ++i) {
+                for (int s = 1; s < 8; ++s) t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xff];
+            }
+        }
+    };
+
+    const Tables& tables() {
+        static const Tables tables;
+        return tables;
+    }
+
+    // slicing-by-8: eight table lookups per 8 input bytes
+    quint32 software(const uchar* p, qint64 n, quint32 crc) {
+        const auto& t = tables().t;
+        for (; n >= 8; p += 8, n -= 8) {
+            quint32 lo;
+            quint32 hi;
+            std::memcpy(&lo, p, 4);
+            std::memcpy(&hi, p + 4, 4);
+            lo ^= crc; // little-endian hosts only, like the rest of the pak reader
+            crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24]
+                ^ t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+        }
+        while (n-- > 0) crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xff];
+        return crc;
+    }
+
+#ifdef CRC32C_X86
+    bool cpuHasSse42() {
+#ifdef _MSC_VER
+        int info[4] = {};
+        __cpuid(info, 1);
+        return (info[2] & (1 << 20)) != 0;
+#else
+        unsigned eax, ebx, ecx, edx;
+        return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_SSE4_2);
+#endif
+    }
+
+    CRC32C_TARGET_SSE42 quint32 hardware(const uchar* p, qint64 n, quint32 crc) {
+        quint64 c = crc;
+        for (; n >= 8; p += 8, n -= 8) {
+            quint64 v;
+            std::memcpy(&v, p, 8);
+            c = _mm_crc32_u64(c, v);
+        }
+        quint32 c32 = quint32(c);
+        while (n-- > 0) c32 = _mm_crc32_u8(c32, *p++);
+        return c32;
+    }
+#endif
+}
+
+namespace Crc32c {
+    bool isHardwareAccelerated() {
+#ifdef CRC32C_X86
+        static const bool has = cpuHasSse42();
+        return has;
+#else
+        return false;
+#endif
+    }
+
+    quint32 compute(const void* data, qint64 size, quint32 crc) {
+        const uchar* p = static_cast<const uchar*>(data);
+        crc = ~crc;
+#ifdef CRC32C_X86
+        if (isHardwareAccelerated()) return ~hardware(p, size, crc);
+#endif
+        return ~software(p, size, crc);
+    }
+}
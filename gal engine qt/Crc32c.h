@@ -0,0 +1,11 @@
+#pragma once
+#include <QtGlobal>
+
+// CRC32C (Castagnoli), the checksum the packer stores per pak entry.
+// Uses the SSE4.2 crc32 instruction when the CPU has it (checked once at
+// runtime), otherwise a slicing-by-8 table. Both give identical results.
+namespace Crc32c {
+    // Pass a previous result as `crc` to continue over split buffers.
+    quint32 compute(const void* data, qint64 size, quint32 crc = 0);
+    bool isHardwareAccelerated();
+}
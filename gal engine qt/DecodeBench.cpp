@@ -0,0 +1,73 @@
+#include "DecodeBench.h"
+#include "ImageDecodeQueue.h"
+#include "QoiImage.h"
+#include "RawImage.h"
+#include "ResourceManager.h"
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <functional>
+
+namespace {
+    struct Result {
+        double msPerImage = 0;
+        bool ok = false;
+    };
+
+    Result timeDecode(const QByteArray& data, int iterations, const std::function<QImage(const QByteArray&)>& decode) {
+        Result r;
+        decode(data); // warm up
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < iterations; ++i) {
+            QImage image = decode(data);
+            if (image.isNull()) return r;
+        }
+        r.msPerImage = timer.nsecsElapsed() / 1e6 / iterations;
+        r.ok = true;
+        return r;
+    }
+}
+
+namespace DecodeBench {
+    int run(const QString& imagePath, int iterations) {
+        QTextStream out(stdout);
+        const QImage source = ImageDecodeQueue::decode(ResourceManager::instance().getData(imagePath));
+        if (source.isNull()) {
+            out << "cannot load " << imagePath << "\n";
+            return 1;
+        }
+
+        QByteArray png;
+        QBuffer buffer(&png);
+        buffer.open(QIODevice::WriteOnly);
+        source.save(&buffer, "PNG");
+        const QByteArray qoi = QoiImage::encode(source);
+        const QByteArray raw = RawImage::toData(source);
+
+        // every variant ends as the premultiplied image the paint path wants;
+        // the raw blob still pays the copy QPixmap::fromImage makes
+        const QImage::Format paintFormat = source.hasAlphaChannel()
+            ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32;
+        struct Case {
+            const char* name;
+            const QByteArray& data;
+            std::function<QImage(const QByteArray&)> decode;
+        };
+        const Case cases[] = {
+            { "png", png, [&](const QByteArray& d) { return QImage::fromData(d, "PNG").convertToFormat(paintFormat); } },
+            { "qoi", qoi, [](const QByteArray& d) { return QoiImage::decode(d); } },
+            { "raw", raw, [](const QByteArray& d) { return RawImage::fromData(d).copy(); } },
+        };
+
+        out << imagePath << " " << source.width() << "x" << source.height()
+            << ", " << iterations << " iterations\n";
+        for (const Case& c : cases) {
+            const Result r = timeDecode(c.data, iterations, c.decode);
+            out << QString("%1  %2 KiB  ").arg(c.name, -4).arg(c.data.size() / 1024.0, 9, 'f', 1);
+            if (r.ok) out << QString("%1 ms/image\n").arg(r.msPerImage, 8, 'f', 3);
+            else out << "decode failed\n";
+        }
+        return 0;
+    }
+}
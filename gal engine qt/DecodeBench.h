@@ -0,0 +1,13 @@
+#pragma once
+#include <QString>
+
+// Decode microbenchmark: `galengine --bench-decode [image] [iterations]`.
+// Re-encodes one image (a 1280x720 background by default) as PNG, QOI and a
+// raw premultiplied blob, then times decoding each to a paintable QImage.
+// Results go to stdout; redirect to a file on Windows.
+namespace DecodeBench {
+    constexpr const char* DEFAULT_IMAGE = "assets/bg/black.png";
+    constexpr int DEFAULT_ITERATIONS = 50;
+
+    int run(const QString& imagePath, int iterations);
+}
@@ -3,6 +3,7 @@
 #include <QWidget>
 #include "OutlineLabel.h"
 #include "OutlineTextBrowser.h"
+#include "Trace.h"
 
 class DialogueBox : public QFrame {
     Q_OBJECT
@@ -12,7 +13,7 @@ public:
     void setText(const QString& t);
 
     bool isTyping() const {
-        qWarning() << "is Typing: " << m_text->isAnimationComplete() << " ! ! ! ";
+        GE_TRACE_DEBUG(lcUi) << "is Typing:" << m_text->isAnimationComplete();
         return m_text->isAnimationComplete(); 
     }
     void skipTyping() { m_text->skipAnimation(); }
@@ -8,7 +8,7 @@
 #include <QPushButton>
 #include <QLabel>
 #include <QDir>
-#include <QFileInfoList>
+#include <QFileInfo>
 #include <QPixmap>
 #include <QScrollArea>
 #include <QDebug>
@@ -22,6 +22,7 @@ const QString LOGO_IMAGE_PATH = "resources/logo.png";
 const double LOGO_SCALE_FACTOR = 0.3;
 const int BUTTON_WIDTH = 160;
 const int BUTTON_HEIGHT = 50;
+const QSize THUMBNAIL_SIZE(100, 100);
 
 const QString GALLERY_BGM_PATH = "resources/mako.mp3";
 const QString CG_SOUND_PATH = "resources/CG.mp3";
@@ -133,6 +134,8 @@ GalleryWindow::GalleryWindow(QWidget* parent) : QWidget(parent)
     connect(returnBtn, &QPushButton::clicked, this, &GalleryWindow::onReturnGame);
     connect(prevBtn, &QPushButton::clicked, this, &GalleryWindow::showPrevImage);
     connect(nextBtn, &QPushButton::clicked, this, &GalleryWindow::showNextImage);
+    connect(&ResourceManager::instance().thumbnails(), &ThumbnailCache::ready,
+        this, &GalleryWindow::onThumbnailReady);
 
     logoPixmap = ResourceManager::instance().getPixmap(LOGO_IMAGE_PATH);
     if (logoPixmap.isNull()) {
@@ -228,12 +231,8 @@ void GalleryWindow::loadImages(const QString& folder)
     clearImages();
 
     ResourceManager& rm = ResourceManager::instance();
-    QStringList filters = { "*.png", "*.jpg", "*.jpeg" };
-    QFileInfoList files = rm.getFileList(folder, filters);
-
-    for (auto& file : files) {
-        imageList.append(file.absoluteFilePath());
-    }
+    QStringList filters = { "*.png", "*.jpg", "*.jpeg", "*.qoi" };
+    imageList = rm.listFiles(folder, filters);
     currentIndex = 0;
     updateDisplay();
     updatePreview();
@@ -241,6 +240,8 @@ void GalleryWindow::loadImages(const QString& folder)
 
 void GalleryWindow::clearImages()
 {
+    ResourceManager::instance().thumbnails().cancelAll();
+    m_pendingThumbs.clear();
     imageList.clear();
     currentIndex = -1;
     displayLabel->clear();
@@ -255,9 +256,8 @@ void GalleryWindow::clearImages()
 void GalleryWindow::updateDisplay()
 {
     if (currentIndex >= 0 && currentIndex < imageList.size()) {
-        QPixmap pix = ResourceManager::instance().getPixmap(imageList[currentIndex]);
+        QPixmap pix = ResourceManager::instance().getPixmap(imageList[currentIndex], displayLabel->size() * g_scaler);
         if (!pix.isNull()) {
-            pix = pix.scaled(displayLabel->size() * g_scaler, Qt::KeepAspectRatio, Qt::SmoothTransformation);
             displayLabel->setPixmap(pix);
         }
         else {
@@ -269,14 +269,18 @@ void GalleryWindow::updateDisplay()
 
 void GalleryWindow::updatePreview()
 {
+    ThumbnailCache& thumbs = ResourceManager::instance().thumbnails();
     for (int i = 0; i < imageList.size(); ++i) {
-        QPixmap pix = ResourceManager::instance().getPixmap(imageList[i]);
         auto* thumb = new ClickableLabel(i);
-        if (!pix.isNull()) {
-            thumb->setPixmap(pix.scaled(100, 100, Qt::KeepAspectRatio, Qt::SmoothTransformation));
+        const QImage image = thumbs.find(imageList[i], THUMBNAIL_SIZE);
+        // a hit may still be replaced once its source has been checked
+        m_pendingThumbs.insert(imageList[i], thumb);
+        if (!image.isNull()) {
+            thumb->setPixmap(QPixmap::fromImage(image));
         }
         else {
-            thumb->setText("Not found");
+            thumb->setText("Loading...");
+            thumbs.request(imageList[i], THUMBNAIL_SIZE);
         }
         thumb->setStyleSheet("border:2px solid gray;");
         previewLayout->addWidget(thumb);
@@ -286,6 +290,20 @@ void GalleryWindow::updatePreview()
 }
 
 
+void GalleryWindow::onThumbnailReady(const QString& path, const QSize& box, const QImage& image)
+{
+    if (box != THUMBNAIL_SIZE) return;
+    ClickableLabel* thumb = m_pendingThumbs.take(path);
+    if (!thumb) return;
+
+    if (!image.isNull()) {
+        thumb->setPixmap(QPixmap::fromImage(image));
+    }
+    else {
+        thumb->setText("Not found");
+    }
+}
+
 void GalleryWindow::onThumbnailClicked(int index)
 {
     if (index >= 0 && index < imageList.size()) {
@@ -329,11 +347,10 @@ void GalleryWindow::loadMusic(const QString& folder)
 
     ResourceManager& rm = ResourceManager::instance();
     QStringList filters = { "*.mp3", "*.wav", "*.ogg", "*.m4a", "*.opus" };
-    QFileInfoList files = rm.getFileList(folder, filters);
+    const QStringList files = rm.listFiles(folder, filters);
 
-    for (int i = 0; i < files.size(); ++i) {
-        QString path = files[i].absoluteFilePath();
-        QString name = files[i].baseName();
+    for (const QString& path : files) {
+        QString name = QFileInfo(path).baseName();
 
         QPushButton* musicItem = new QPushButton(name, this);
         musicItem->setFixedSize(150, 40);
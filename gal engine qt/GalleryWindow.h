@@ -10,6 +10,7 @@
 #include <QMediaPlayer>
 #include <QAudioOutput>
 #include <QPointer>
+#include <QHash>
 #include "AudioManager.h"
 
 class QMediaPlayer;
@@ -19,6 +20,7 @@ class QPushButton;
 class MainWindow;
 class SettingWindow;
 class StartWindow;
+class ClickableLabel;
 
 class GalleryWindow : public QWidget {
     Q_OBJECT
@@ -35,6 +37,7 @@ private slots:
     void showNextImage();
     void onThumbnailClicked(int index);
     void onMusicGame();
+    void onThumbnailReady(const QString& path, const QSize& box, const QImage& image);
 
 
 private:
@@ -66,6 +69,7 @@ private:
     QPixmap logoPixmap;
 
     QStringList imageList;
+    QHash<QString, ClickableLabel*> m_pendingThumbs; // waiting on the thumbnail cache, or shown from it unchecked
     int currentIndex = -1;
 
     void loadImages(const QString& folder);
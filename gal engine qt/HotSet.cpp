@@ -0,0 +1,75 @@
+#include "HotSet.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+
+bool HotSet::load(const QString& filename) {
+    m_entries.clear();
+    QFile f(filename);
+    if (!f.open(QIODevice::ReadOnly)) return false;
+
+    const QJsonObject root = QJsonDocument::fromJson(f.readAll()).object();
+    if (root.value("version").toInt() != VERSION) return false;
+    for (const QJsonValue& v : root.value("assets").toArray()) {
+        const QJsonObject o = v.toObject();
+        Entry e;
+        e.path = o.value("path").toString();
+        e.audio = o.value("audio").toBool();
+        e.score = o.value("score").toDouble();
+        e.bytes = qint64(o.value("bytes").toDouble());
+        if (!e.path.isEmpty()) m_entries.append(e);
+    }
+    return true;
+}
+
+bool HotSet::save(const QString& filename) const {
+    QJsonArray assets;
+    for (const Entry& e : m_entries) {
+        QJsonObject o;
+        o["path"] = e.path;
+        o["audio"] = e.audio;
+        o["score"] = e.score;
+        o["bytes"] = double(e.bytes);
+        assets.append(o);
+    }
+    QJsonObject root;
+    root["version"] = VERSION;
+    root["assets"] = assets;
+
+    QDir().mkpath(QFileInfo(filename).path());
+    QFile f(filename);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    return f.write(QJsonDocument(root).toJson(QJsonDocument::Indented)) >= 0;
+}
+
+void HotSet::update(const QVector<Entry>& session) {
+    QHash<QString, int> index;
+    for (int i = 0; i < m_entries.size(); ++i) {
+        m_entries[i].score *= DECAY;
+        index.insert(m_entries[i].path, i);
+    }
+    for (const Entry& s : session) {
+        const double accesses = qMin(s.score, double(ACCESS_CAP));
+        auto it = index.constFind(s.path);
+        if (it == index.constEnd()) {
+            index.insert(s.path, m_entries.size());
+            m_entries.append(s);
+            m_entries.last().score = accesses;
+            continue;
+        }
+        Entry& e = m_entries[it.value()];
+        e.score += accesses;
+        e.audio = s.audio;
+        if (s.bytes > 0) e.bytes = s.bytes;
+    }
+
+    m_entries.removeIf([](const Entry& e) { return e.score < MIN_SCORE; });
+    std::stable_sort(m_entries.begin(), m_entries.end(),
+        [](const Entry& a, const Entry& b) { return a.score > b.score; });
+    if (m_entries.size() > MAX_ENTRIES) m_entries.resize(MAX_ENTRIES);
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <QString>
+#include <QVector>
+
+// The assets worth having ready before the player clicks anything: whatever
+// recent sessions kept using (title screen art, UI sounds, the current
+// chapter), ranked by access counts that decay by DECAY per session, so one
+// long play-through does not crowd out what every launch needs.
+// Stored as JSON ({ "version", "assets": [{ path, audio, score, bytes }] }),
+// best first; bytes is the decoded size of an image, 0 for audio.
+class HotSet {
+public:
+    static constexpr int VERSION = 1;
+    static constexpr double DECAY = 0.5;     // weight of the previous sessions
+    static constexpr int ACCESS_CAP = 16;    // per asset and session; repaints would dominate otherwise
+    static constexpr int MAX_ENTRIES = 64;
+    static constexpr double MIN_SCORE = 0.5; // dropped below this
+
+    struct Entry {
+        QString path;
+        bool audio = false;
+        double score = 0;   // loading: decayed score; update(): this session's accesses
+        qint64 bytes = 0;
+    };
+
+    // A missing or unreadable file is an empty set.
+    bool load(const QString& filename);
+    bool save(const QString& filename) const;
+
+    // Folds one session in: old scores decay, this session's accesses
+    // (capped at ACCESS_CAP) are added, then the set is re-ranked and trimmed.
+    void update(const QVector<Entry>& session);
+
+    const QVector<Entry>& entries() const { return m_entries; } // best first
+    bool isEmpty() const { return m_entries.isEmpty(); }
+
+private:
+    QVector<Entry> m_entries;
+};
@@ -0,0 +1,145 @@
+#include "ImageDecodeQueue.h"
+#include "RawImage.h"
+#include "QoiImage.h"
+#include <QMetaObject>
+#include <QThread>
+#include <QElapsedTimer>
+
+ImageDecodeQueue::ImageDecodeQueue(Loader loader, QObject* parent)
+    : QObject(parent), m_loader(std::move(loader)) {
+    // leave one core for the GUI thread
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+}
+
+ImageDecodeQueue::~ImageDecodeQueue() {
+    blockSignals(true);
+    cancelAll();
+    m_pool.waitForDone();
+}
+
+void ImageDecodeQueue::request(AssetId id, Priority priority) {
+    if (id == INVALID_ASSET) return;
+
+    QMutexLocker lock(&m_mutex);
+    if (m_running.contains(id)) {
+        m_cancelled.remove(id);
+        return;
+    }
+
+    auto it = m_queued.find(id);
+    if (it != m_queued.end()) {
+        if (priority > it.value()) {
+            m_queues[it.value()].removeOne(id);
+            m_queues[priority].append(id);
+            it.value() = priority;
+        }
+        return;
+    }
+
+    m_queues[priority].append(id);
+    m_queued.insert(id, priority);
+    lock.unlock();
+
+    startWorker();
+}
+
+void ImageDecodeQueue::setPriority(AssetId id, Priority priority) {
+    QMutexLocker lock(&m_mutex);
+    auto it = m_queued.find(id);
+    if (it == m_queued.end() || it.value() == priority) return;
+
+    m_queues[it.value()].removeOne(id);
+    m_queues[priority].append(id);
+    it.value() = priority;
+}
+
+void ImageDecodeQueue::cancel(AssetId id) {
+    bool dropped = false;
+    {
+        QMutexLocker lock(&m_mutex);
+        auto it = m_queued.find(id);
+        if (it != m_queued.end()) {
+            m_queues[it.value()].removeOne(id);
+            m_queued.erase(it);
+            dropped = true;
+        }
+        if (m_running.contains(id)) m_cancelled.insert(id);
+    }
+    // a running decode reports from finish() instead
+    if (dropped) emit cancelled(id);
+}
+
+void ImageDecodeQueue::cancelAll() {
+    QList<AssetId> dropped;
+    {
+        QMutexLocker lock(&m_mutex);
+        dropped = m_queued.keys();
+        for (auto& q : m_queues) q.clear();
+        m_queued.clear();
+        m_cancelled.unite(m_running);
+    }
+    for (AssetId id : std::as_const(dropped)) emit cancelled(id);
+}
+
+bool ImageDecodeQueue::isPending(AssetId id) const {
+    QMutexLocker lock(&m_mutex);
+    return m_queued.contains(id) || (m_running.contains(id) && !m_cancelled.contains(id));
+}
+
+QImage ImageDecodeQueue::decode(const QByteArray& data) {
+    // pre-decoded blobs from the packer are wrapped as-is, no codec involved
+    if (RawImage::isRawImage(data)) return RawImage::fromData(data);
+    if (QoiImage::isQoi(data)) return QoiImage::decode(data);
+
+    QImage image;
+    if (!data.isEmpty()) image.loadFromData(data);
+    return image;
+}
+
+void ImageDecodeQueue::startWorker() {
+    // one pool task per request; each task takes whatever is most urgent when it runs
+    m_pool.start([this]() {
+        AssetId id;
+        {
+            QMutexLocker lock(&m_mutex);
+            if (!takeNext(id)) return;
+            m_running.insert(id);
+        }
+
+        const QByteArray data = m_loader(id);
+        QElapsedTimer timer;
+        timer.start();
+        QImage image = decode(data);
+        if (m_observer) m_observer(id, timer.nsecsElapsed(), image);
+        QMetaObject::invokeMethod(this, [this, id, image]() {
+            finish(id, image);
+        }, Qt::QueuedConnection);
+    });
+}
+
+bool ImageDecodeQueue::takeNext(AssetId& id) {
+    for (int p = PriorityCount - 1; p >= 0; --p) {
+        if (!m_queues[p].isEmpty()) {
+            id = m_queues[p].takeFirst();
+            m_queued.remove(id);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ImageDecodeQueue::finish(AssetId id, const QImage& image) {
+    bool dropped;
+    {
+        QMutexLocker lock(&m_mutex);
+        m_running.remove(id);
+        dropped = m_cancelled.remove(id);
+    }
+    if (dropped) {
+        emit cancelled(id);
+        return;
+    }
+
+    if (image.isNull()) emit failed(id);
+    else emit decoded(id, image);
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <QObject>
+#include <QImage>
+#include <QThreadPool>
+#include <QMutex>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QByteArray>
+#include <functional>
+#include "AssetId.h"
+
+// Decodes images to QImage on worker threads. Requests are served highest
+// priority first (FIFO within a priority); results are delivered on the thread
+// that owns the queue, which is where QPixmap conversion must happen.
+class ImageDecodeQueue : public QObject {
+    Q_OBJECT
+public:
+    enum Priority {
+        Speculative = 0,  // preload / prefetch
+        NextLine = 1,     // needed within the next few lines
+        VisibleNow = 2,   // on screen as soon as it is ready
+        PriorityCount
+    };
+
+    using Loader = std::function<QByteArray(AssetId id)>;
+    // Called on the worker thread after each decode, before delivery.
+    using DecodeObserver = std::function<void(AssetId id, qint64 decodeNs, const QImage& image)>;
+
+    explicit ImageDecodeQueue(Loader loader, QObject* parent = nullptr);
+    ~ImageDecodeQueue();
+
+    // Queue a decode, or raise the priority of one that is already queued.
+    void request(AssetId id, Priority priority);
+    // Move a queued request to exactly this priority (can lower it).
+    void setPriority(AssetId id, Priority priority);
+    // Drop a queued request; a decode already running is discarded when done.
+    // Either way cancelled() is emitted, so waiters can be told.
+    void cancel(AssetId id);
+    void cancelAll();
+
+    bool isPending(AssetId id) const;
+
+    // Set before the first request.
+    void setDecodeObserver(DecodeObserver observer) { m_observer = std::move(observer); }
+
+    static QImage decode(const QByteArray& data);
+
+signals:
+    void decoded(AssetId id, const QImage& image);
+    void failed(AssetId id);
+    // A request ended by cancel() / cancelAll() without a result.
+    void cancelled(AssetId id);
+
+private:
+    void startWorker();
+    bool takeNext(AssetId& id);
+    void finish(AssetId id, const QImage& image);
+
+    Loader m_loader;
+    DecodeObserver m_observer;
+    QThreadPool m_pool;
+
+    mutable QMutex m_mutex;
+    QList<AssetId> m_queues[PriorityCount];
+    QHash<AssetId, Priority> m_queued;
+    QSet<AssetId> m_running;
+    QSet<AssetId> m_cancelled;
+};
@@ -3,6 +3,27 @@
 #include <QPropertyAnimation>
 #include <QGraphicsOpacityEffect>
 
+namespace {
+    // λ̶Сü水ԭλðڷţǩֻвüô
+    // ͸߼ȲռڴҲÿ֡ϡ
+    // ȲλʱλĲִͼе trimδüʱǩصЧһ
+    void placeSprite(QLabel* lbl, const QRect& slot, SpriteTrim& trim) {
+        if (!trim.isTrimmed() || lbl->pixmap().isNull()) {
+            lbl->setGeometry(slot);
+            return;
+        }
+        // QLabel Ĭ롢ֱУԭڲλ
+        const QPoint origin = slot.topLeft() + QPoint(0, (slot.height() - trim.canvas.height()) / 2);
+        const QRect rect(origin + trim.offset, lbl->pixmap().size());
+        const QRect visible = rect & slot;
+        if (visible != rect && !visible.isEmpty()) {
+            lbl->setPixmap(lbl->pixmap().copy(visible.translated(-rect.topLeft())));
+            trim.offset += visible.topLeft() - rect.topLeft();
+        }
+        lbl->setGeometry(visible.isEmpty() ? QRect(slot.topLeft(), QSize(0, 0)) : visible);
+    }
+}
+
 ImageLayer::ImageLayer(QWidget* parent) : QWidget(parent) {
     setAttribute(Qt::WA_TranslucentBackground);
     setAttribute(Qt::WA_NoSystemBackground, true);
@@ -33,10 +54,11 @@ QLabel* ImageLayer::pick(const QString& slot) {
     return m_pleft;
 }
 
-void ImageLayer::setSprite(const QString& slot, const QPixmap& px, int fadeInDuration)
+void ImageLayer::setSprite(const QString& slot, const QPixmap& px, int fadeInDuration, const SpriteTrim& trim)
 {
     QLabel* lbl = pick(slot);
     if (!lbl) return;
+    m_trims.insert(lbl, trim);
 
     if (m_animations.contains(lbl)) {
         QPropertyAnimation* oldAnim = m_animations.value(lbl);
@@ -132,13 +154,13 @@ void ImageLayer::layoutSprites() {
     const int h = height();
     const int baseW = w / 3;
     const int baseH = h;
-    m_lleft->setGeometry(260, 0, 510, 720);
-    m_left->setGeometry(640 - 255, 0, 510, 720);
+    placeSprite(m_lleft, QRect(260, 0, 510, 720), m_trims[m_lleft]);
+    placeSprite(m_left, QRect(640 - 255, 0, 510, 720), m_trims[m_left]);
     //m_center->setGeometry((w - baseW) / 2, h - baseH, baseW, baseH);
-    m_right->setGeometry(260 + 510, 0, 510, 720);
-    m_pleft->setGeometry(0, 460, 260, 260);
-    m_pcenter->setGeometry(260, 460, 260, 260);
-    m_pright->setGeometry(260 + 510, 460, 260, 260);
+    placeSprite(m_right, QRect(260 + 510, 0, 510, 720), m_trims[m_right]);
+    placeSprite(m_pleft, QRect(0, 460, 260, 260), m_trims[m_pleft]);
+    placeSprite(m_pcenter, QRect(260, 460, 260, 260), m_trims[m_pcenter]);
+    placeSprite(m_pright, QRect(260 + 510, 460, 260, 260), m_trims[m_pright]);
 }
 
 
@@ -172,11 +194,12 @@ QLabel* ImageLayerTop::pick(const QString& slot) {
     return m_pleft;
 }
 
-void ImageLayerTop::setSpriteTop(const QString& slot, const QPixmap& px) {
+void ImageLayerTop::setSpriteTop(const QString& slot, const QPixmap& px, const SpriteTrim& trim) {
     QLabel* lbl = pick(slot);
     Qt::WindowFlags flags = windowFlags();
     setWindowFlags(flags | Qt::WindowStaysOnTopHint | Qt::FramelessWindowHint);
     if (!lbl) return;
+    m_trims.insert(lbl, trim);
     lbl->setPixmap(px);
     raise();
     lbl->show();
@@ -204,11 +227,11 @@ void ImageLayerTop::layoutSprites() {
     const int h = height();
     const int baseW = w / 3;
     const int baseH = h;
-    m_left->setGeometry(260, 0, 510, 720);
-    m_left->setGeometry(640 - 255, 0, 510, 720);
+    placeSprite(m_left, QRect(260, 0, 510, 720), m_trims[m_left]);
+    placeSprite(m_left, QRect(640 - 255, 0, 510, 720), m_trims[m_left]);
     //m_center->setGeometry((w - baseW) / 2, h - baseH, baseW, baseH);
-    m_right->setGeometry(260 + 510, 0, 510, 720);
-    m_pleft->setGeometry(0, 460, 260, 260);
-    m_pcenter->setGeometry(260, 460, 260, 260);
-    m_pright->setGeometry(260 + 510, 460, 260, 260);
+    placeSprite(m_right, QRect(260 + 510, 0, 510, 720), m_trims[m_right]);
+    placeSprite(m_pleft, QRect(0, 460, 260, 260), m_trims[m_pleft]);
+    placeSprite(m_pcenter, QRect(260, 460, 260, 260), m_trims[m_pcenter]);
+    placeSprite(m_pright, QRect(260 + 510, 460, 260, 260), m_trims[m_pright]);
 }
\ No newline at end of file
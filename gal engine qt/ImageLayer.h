@@ -2,12 +2,15 @@
 #include <QWidget>
 #include <QLabel>
 #include <QPropertyAnimation>
+#include <QHash>
+#include "SpriteTrim.h"
 
 class ImageLayer : public QWidget {
     Q_OBJECT
 public:
     explicit ImageLayer(QWidget* parent = nullptr);
-    void setSprite(const QString& slot, const QPixmap& px, int fadeInDuration = 500);
+    // trimʱõ͸ߵ棬ԭƫƷ
+    void setSprite(const QString& slot, const QPixmap& px, int fadeInDuration = 500, const SpriteTrim& trim = SpriteTrim());
     void clearSprite(const QString& slot, int fadeOutDuration = 500);
     void clearAll();
 
@@ -20,6 +23,7 @@ private:
 
     QMap<QLabel*, QPropertyAnimation*> m_animations;
     int m_defaultFadeDuration = 1000;
+    QHash<QLabel*, SpriteTrim> m_trims;
 
     QLabel* m_lleft;
     QLabel* m_left;
@@ -33,7 +37,7 @@ class ImageLayerTop : public QWidget {
     Q_OBJECT
 public:
     explicit ImageLayerTop(QWidget* parent = nullptr);
-    void setSpriteTop(const QString& slot, const QPixmap& px);
+    void setSpriteTop(const QString& slot, const QPixmap& px, const SpriteTrim& trim = SpriteTrim());
     void clearSpriteTop(const QString& slot);
     void clearAllTop();
 
@@ -44,6 +48,8 @@ private:
     QLabel* pick(const QString& slot);
     void layoutSprites();
 
+    QHash<QLabel*, SpriteTrim> m_trims;
+
     QLabel* m_lleft;
     QLabel* m_left;
     QLabel* m_right;
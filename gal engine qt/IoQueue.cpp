@@ -0,0 +1,158 @@
+#include "IoQueue.h"
+#include <QFile>
+#include <algorithm>
+
+#if defined(Q_OS_UNIX) && !defined(Q_OS_DARWIN)
+#define IOQUEUE_FADVISE 1
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+IoQueue::IoQueue(QObject* parent) : QObject(parent) {
+    m_pool.setMaxThreadCount(1);
+    m_cache.setMaxCost(DEFAULT_CACHE_BUDGET);
+}
+
+IoQueue::~IoQueue() {
+    {
+        QMutexLocker lock(&m_mutex);
+        m_queue.clear();
+        m_advise.clear();
+    }
+    m_pool.waitForDone();
+}
+
+QByteArray IoQueue::read(const QString& file) {
+    QMutexLocker lock(&m_mutex);
+    if (const QByteArray* cached = m_cache.object(file)) return *cached;
+
+    PendingPtr pending = m_pending.value(file);
+    if (pending && pending->reading) {
+        while (!pending->done) m_finished.wait(&m_mutex);
+        return pending->data;
+    }
+    if (pending) {
+        m_queue.removeOne(file); // queued for readahead: read it here instead of waiting
+    }
+    else {
+        pending = std::make_shared<Pending>();
+        m_pending.insert(file, pending);
+    }
+    pending->reading = true;
+    lock.unlock();
+
+    const QByteArray data = readFile(file);
+    complete(file, pending, data);
+    return data;
+}
+
+void IoQueue::prefetch(const QStringList& files) {
+    {
+        QMutexLocker lock(&m_mutex);
+        for (const QString& file : files) {
+            if (m_pending.contains(file) || m_cache.contains(file)) continue;
+            m_pending.insert(file, std::make_shared<Pending>());
+            m_queue.append(file);
+        }
+    }
+    startWorker();
+}
+
+void IoQueue::advise(const QStringList& files) {
+    {
+        QMutexLocker lock(&m_mutex);
+        m_advise.append(files);
+    }
+    startWorker();
+}
+
+bool IoQueue::isCached(const QString& file) const {
+    QMutexLocker lock(&m_mutex);
+    return m_cache.contains(file);
+}
+
+void IoQueue::setCacheBudget(qint64 bytes) {
+    QMutexLocker lock(&m_mutex);
+    m_cache.setMaxCost(bytes);
+}
+
+void IoQueue::clear() {
+    QMutexLocker lock(&m_mutex);
+    m_cache.clear();
+}
+
+void IoQueue::startWorker() {
+    QMutexLocker lock(&m_mutex);
+    if (m_workerRunning || (m_queue.isEmpty() && m_advise.isEmpty())) return;
+    m_workerRunning = true;
+    lock.unlock();
+    m_pool.start([this]() { drain(); });
+}
+
+void IoQueue::drain() {
+    for (;;) {
+        QStringList advise;
+        QStringList batch;
+        {
+            QMutexLocker lock(&m_mutex);
+            advise.swap(m_advise);
+            batch = m_queue.mid(0, MAX_BATCH);
+            m_queue.remove(0, batch.size());
+            if (advise.isEmpty() && batch.isEmpty()) {
+                m_workerRunning = false;
+                return;
+            }
+        }
+
+        // hint everything first so the reads below find the data in flight
+        for (const QString& file : std::as_const(advise)) adviseFile(file);
+        for (const QString& file : std::as_const(batch)) adviseFile(file);
+        // neighbours on disk tend to be neighbours by path
+        std::sort(batch.begin(), batch.end());
+
+        for (const QString& file : std::as_const(batch)) {
+            PendingPtr pending;
+            {
+                QMutexLocker lock(&m_mutex);
+                pending = m_pending.value(file);
+                if (!pending || pending->reading) continue; // taken over by read()
+                pending->reading = true;
+            }
+            complete(file, pending, readFile(file));
+        }
+    }
+}
+
+void IoQueue::complete(const QString& file, const PendingPtr& pending, const QByteArray& data) {
+    {
+        QMutexLocker lock(&m_mutex);
+        pending->data = data;
+        pending->done = true;
+        if (m_pending.value(file) == pending) m_pending.remove(file);
+        // files over the whole budget are refused by the cache and just returned
+        if (!data.isNull()) m_cache.insert(file, new QByteArray(data), qMax<qsizetype>(data.size(), 1));
+    }
+    m_finished.wakeAll();
+}
+
+QByteArray IoQueue::readFile(const QString& file) {
+    QFile f(file);
+    if (!f.open(QIODevice::ReadOnly)) return QByteArray();
+    return f.readAll();
+}
+
+void IoQueue::adviseFile(const QString& file) {
+#ifdef IOQUEUE_FADVISE
+    const int fd = ::open(QFile::encodeName(file).constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    ::close(fd);
+#else
+    // no readahead hint on this platform; touching the start of the file at
+    // least gets the first reads of the consumer served from the system cache
+    QFile f(file);
+    if (!f.open(QIODevice::ReadOnly)) return;
+    char buffer[64 * 1024];
+    f.read(buffer, sizeof(buffer));
+#endif
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <QObject>
+#include <QByteArray>
+#include <QCache>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <memory>
+
+// Raw file reads for loose (unpacked) resources, behind a byte-bounded LRU
+// cache. Readahead runs on one dedicated I/O thread: it takes the queued
+// files in batches, hints the whole batch to the OS first (posix_fadvise
+// WILLNEED where available) so the disk can fetch them together, then reads
+// them in path order into the cache. A file is read once however many
+// callers want it: read() returns a cached copy, waits for a read already
+// running, or takes a still-queued file over and reads it itself.
+// read() blocks, so the GUI thread should only hit files prefetched earlier;
+// decoder threads call it freely. Paths are host paths.
+class IoQueue : public QObject {
+    Q_OBJECT
+public:
+    static constexpr qint64 DEFAULT_CACHE_BUDGET = 64 * 1024 * 1024;
+    static constexpr int MAX_BATCH = 16; // readahead files per batch
+
+    explicit IoQueue(QObject* parent = nullptr);
+    ~IoQueue();
+
+    // Null if the file cannot be read.
+    QByteArray read(const QString& file);
+    // Read into the cache on the I/O thread.
+    void prefetch(const QStringList& files);
+    // Only hint the OS that the files are needed soon, for consumers that
+    // read them themselves (QMediaPlayer); runs on the I/O thread.
+    void advise(const QStringList& files);
+
+    bool isCached(const QString& file) const;
+    void setCacheBudget(qint64 bytes);
+    void clear();
+
+private:
+    struct Pending {
+        bool reading = false; // false while queued, when read() may take it over
+        bool done = false;
+        QByteArray data;
+    };
+    using PendingPtr = std::shared_ptr<Pending>;
+
+    void startWorker();
+    void drain();
+    void complete(const QString& file, const PendingPtr& pending, const QByteArray& data);
+    static QByteArray readFile(const QString& file);
+    static void adviseFile(const QString& file);
+
+    QThreadPool m_pool; // the I/O thread
+    mutable QMutex m_mutex;
+    QWaitCondition m_finished;
+    QHash<QString, PendingPtr> m_pending; // queued or being read
+    QStringList m_queue;  // readahead, FIFO
+    QStringList m_advise;
+    bool m_workerRunning = false;
+    QCache<QString, QByteArray> m_cache; // cost = bytes
+};
@@ -3,6 +3,7 @@
 #include "StartWindow.h"
 #include "SaveLoadWindow.h"
 #include "SettingWindow.h"
+#include "Trace.h"
 #include <QFileDialog>
 #include <QStatusBar>
 #include <QMessageBox>
@@ -127,11 +128,9 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
     layoutUi();
 
 
-    QString jsonPath;
-    if (ResourceManager::USE_PACKED_RESOURCES) {
-        jsonPath = "assets/script.json";
-    }
-    else {
+    // ԴĽűȣùĿ¼µ script.json
+    QString jsonPath = "assets/script.json";
+    if (!ResourceManager::instance().exists(jsonPath)) {
         jsonPath = QDir::current().filePath("script.json");
     }
 
@@ -244,6 +243,9 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
 
 MainWindow::~MainWindow() {
     qApp->removeEventFilter(this);
+
+    auto& rm = ResourceManager::instance();
+    for (AssetId id : m_pinnedAssets) rm.unpinPixmap(id);
 }
 
 void MainWindow::resizeEvent(QResizeEvent* ev) {
@@ -297,12 +299,14 @@ void MainWindow::keyReleaseEvent(QKeyEvent* ev) {
     }
 }
 
-void MainWindow::onBackgroundChanged(const QString& path) {
-    auto& rm = ResourceManager::instance();
-    QPixmap px = rm.getPixmap(path);
+void MainWindow::onBackgroundChanged(AssetId id) {
+    requestShown(id, [this, id](const QPixmap& px) { showBackground(id, px); });
+}
 
+void MainWindow::showBackground(AssetId id, const QPixmap& px) {
     if (px.isNull()) return;
 
+    pinShown("bg", id);
     m_bgPixmap = px;
     m_bg->setPixmap(m_bgPixmap);
 
@@ -329,26 +333,54 @@ void MainWindow::onBackgroundChanged(const QString& path) {
     anim->start(QAbstractAnimation::DeleteWhenStopped);
 }
 
-void MainWindow::onSpriteChanged(const QString& slot, const QString& path) {
-    auto& rm = ResourceManager::instance();
-    QPixmap px = rm.getPixmap(path);
-    if (!px.isNull()) m_layer->setSprite(slot, px);
+void MainWindow::onSpriteChanged(const QString& slot, AssetId id) {
+    requestShown(id, [this, slot, id](const QPixmap& px) {
+        if (px.isNull()) return;
+        pinShown(slot, id);
+        m_layer->setSprite(slot, px, 500, ResourceManager::instance().spriteTrim(id));
+    });
 }
 
-void MainWindow::onSpriteChangedTop(const QString& slot, const QString& path) {
-    auto& rm = ResourceManager::instance();
-    QPixmap px = rm.getPixmap(path);
-    if (!px.isNull()) m_layerT->setSpriteTop(slot, px);
+void MainWindow::onSpriteChangedTop(const QString& slot, AssetId id) {
+    requestShown(id, [this, slot, id](const QPixmap& px) {
+        if (px.isNull()) return;
+        pinShown("top:" + slot, id);
+        m_layerT->setSpriteTop(slot, px, ResourceManager::instance().spriteTrim(id));
+    });
 }
 
 void MainWindow::onSpriteCleared(const QString& slot) {
+    pinShown(slot, INVALID_ASSET);
     m_layer->clearSprite(slot);
 }
 
 void MainWindow::onSpriteClearedTop(const QString& slot) {
+    pinShown("top:" + slot, INVALID_ASSET);
     m_layerT->clearSpriteTop(slot);
 }
 
+void MainWindow::requestShown(AssetId id, std::function<void(const QPixmap&)> show) {
+    if (id == INVALID_ASSET || !show) return;
+    // ǰ̨ı治Ⱥ̨룺ͨԤŽ棬δʱ룬
+    // ֤ͼƬĶ԰ʾں̨ͬһͼ getPixmap ȡ˳
+    show(ResourceManager::instance().getPixmap(id));
+}
+
+void MainWindow::pinShown(const QString& key, AssetId id) {
+    auto& rm = ResourceManager::instance();
+    const AssetId old = m_pinnedAssets.value(key, INVALID_ASSET);
+    if (old == id) return;
+
+    if (id != INVALID_ASSET) {
+        rm.pinPixmap(id);
+        m_pinnedAssets.insert(key, id);
+    }
+    else {
+        m_pinnedAssets.remove(key);
+    }
+    if (old != INVALID_ASSET) rm.unpinPixmap(old);
+}
+
 void MainWindow::onTextReady(const QString& speaker, const QString& text) {
     m_dialogue->setSpeaker(speaker);
     m_dialogue->setText(text);
@@ -576,11 +608,11 @@ void MainWindow::handleAdvance()
     if (!m_dialogue || !m_engine) return;
     if (!iswaiting){
         if (!m_dialogue->isTyping()) {
-            qDebug() << "skip animation";
+            GE_TRACE_DEBUG(lcUi) << "skip animation";
             m_dialogue->skipTyping();
         }
         else if (m_engine) {
-            qDebug() << "skip text";
+            GE_TRACE_DEBUG(lcUi) << "skip text";
             m_engine->advance();
         }
     }
@@ -608,11 +640,11 @@ void MainWindow::handleAdvanceOrSkip() {
         // Ĭģʽ  ֶƽ
         if (!iswaiting) {
             if (!m_dialogue->isTyping()) {
-                qDebug() << "skip animation";
+                GE_TRACE_DEBUG(lcUi) << "skip animation";
                 m_dialogue->skipTyping();
             }
             else if (m_engine) {
-                qDebug() << "skip text";
+                GE_TRACE_DEBUG(lcUi) << "skip text";
                 m_engine->advance();
             }
         }
@@ -31,9 +31,9 @@ protected:
     void showEvent(QShowEvent* event) override;
 
 private slots:
-    void onBackgroundChanged(const QString& path);
-    void onSpriteChanged(const QString& slot, const QString& path);
-    void onSpriteChangedTop(const QString& slot, const QString& path);
+    void onBackgroundChanged(AssetId id);
+    void onSpriteChanged(const QString& slot, AssetId id);
+    void onSpriteChangedTop(const QString& slot, AssetId id);
     void onSpriteCleared(const QString& slot);
     void onSpriteClearedTop(const QString& slot);
     void onTextReady(const QString& speaker, const QString& text);
@@ -68,6 +68,8 @@ private:
     QString m_currentText;
 
     QPixmap m_bgPixmap;
+    QMap<QString, AssetId> m_pinnedAssets; // "bg" / slot / "top:"+slot -> Դ id
+
 
     QPointer<QAbstractAnimation> m_shakeAnimation = nullptr;
 
@@ -91,4 +93,7 @@ private:
     void mousePressEvent(QMouseEvent* ev);
     void keyReleaseEvent(QKeyEvent* ev);
     void enableSkipAllMode(bool enable);
+    void pinShown(const QString& key, AssetId id);
+    void showBackground(AssetId id, const QPixmap& px);
+    void requestShown(AssetId id, std::function<void(const QPixmap&)> show);
 };
@@ -0,0 +1,998 @@
+#include "PakArchive.h"
+#include <QtEndian>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QAtomicInt>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtConcurrent/QtConcurrentRun>
+#include <zlib.h>
+#include <lz4.h>
+#include <zstd.h>
+#include "Crc32c.h"
+#include <memory>
+#include <algorithm>
+#include <limits>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define PAK_XOR_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(Q_OS_WIN)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(Q_OS_UNIX)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    constexpr qint64 HEADER_SIZE = 32;
+    constexpr qint64 RECORD_FIXED_SIZE = 36;
+    constexpr qint64 TRIM_FIELDS_SIZE = 16; // canvasW u32, canvasH u32, offsetX i32, offsetY i32, after the name
+    constexpr qint64 CHECKSUM_FIELD_SIZE = 4; // crc32c u32, after the trim fields
+    constexpr qint64 CHUNK_HEADER_SIZE = 8; // chunkSize u32, chunkCount u32, at the start of chunked data
+    constexpr qint64 CHUNK_RECORD_SIZE = 8; // storedSize u32, crc32c u32 per chunk
+    constexpr qint64 RANGE_CHUNK = 256 * 1024; // readChunk() piece of an unchunked stored entry
+    constexpr qint64 HOT_READ_PIECE = 1024 * 1024; // readHotPrefix() read size
+    constexpr qint64 MAX_RAW_SIZE = qint64(1) << 31; // decoded size beyond this is a damaged record
+
+    bool fitsInt64(quint64 v) {
+        return v <= quint64(std::numeric_limits<qint64>::max());
+    }
+
+    // Largest decoded size `stored` bytes can expand to under `codec`
+    // (deflate tops out near 1032:1, an LZ4 block near 255:1); zstd has no
+    // useful bound below MAX_RAW_SIZE.
+    qint64 maxRawSize(quint8 codec, qint64 stored) {
+        switch (codec) {
+        case PakArchive::CodecStored: return stored;
+        case PakArchive::CodecZlib: return qMin(MAX_RAW_SIZE, qMin(stored, MAX_RAW_SIZE) * 1032 + 64);
+        case PakArchive::CodecLz4: return qMin(MAX_RAW_SIZE, qMin(stored, MAX_RAW_SIZE) * 255 + 64);
+        default: return MAX_RAW_SIZE;
+        }
+    }
+
+    template <typename T>
+    T readLE(const char* p) {
+        return qFromLittleEndian<T>(reinterpret_cast<const uchar*>(p));
+    }
+
+    // one decompression context per worker thread, reused across entries
+    ZSTD_DCtx* zstdContext() {
+        struct Free { void operator()(ZSTD_DCtx* c) const { ZSTD_freeDCtx(c); } };
+        thread_local std::unique_ptr<ZSTD_DCtx, Free> ctx(ZSTD_createDCtx());
+        return ctx.get();
+    }
+
+    // stored bytes pass through this per-thread buffer when they need the XOR
+    // or come from the file, so decoding never holds a full stored copy
+    constexpr qint64 STREAM_CHUNK = 64 * 1024;
+
+    char* chunkBuffer() {
+        thread_local std::unique_ptr<char[]> buffer(new char[STREAM_CHUNK]);
+        return buffer.get();
+    }
+
+    // dst may equal src
+    void xorInto(char* dst, const char* src, qint64 n) {
+        qint64 i = 0;
+#ifdef PAK_XOR_SSE2
+        const __m128i key = _mm_set1_epi8(PakArchive::XOR_KEY);
+        for (; i + 64 <= n; i += 64) {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16));
+            const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 32));
+            const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 48));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(a, key));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 16), _mm_xor_si128(b, key));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 32), _mm_xor_si128(c, key));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 48), _mm_xor_si128(d, key));
+        }
+#endif
+        const quint64 key8 = 0x0101010101010101ull * quint8(PakArchive::XOR_KEY);
+        for (; i + 8 <= n; i += 8) {
+            quint64 v;
+            memcpy(&v, src + i, 8);
+            v ^= key8;
+            memcpy(dst + i, &v, 8);
+        }
+        for (; i < n; ++i) dst[i] = src[i] ^ PakArchive::XOR_KEY;
+    }
+
+    // zlib stream of unknown size (v1): XOR and inflate chunk by chunk into
+    // one growing buffer, trimmed to fit at the end
+    QByteArray inflateGrowing(const char* data, qint64 size, bool decrypt) {
+        z_stream strm;
+        memset(&strm, 0, sizeof(strm));
+        if (inflateInit(&strm) != Z_OK) return QByteArray();
+
+        QByteArray result(qMax<qint64>(size * 4, STREAM_CHUNK), Qt::Uninitialized);
+        char* buffer = chunkBuffer();
+        int ret = Z_OK;
+        for (qint64 pos = 0; pos < size && ret == Z_OK; ) {
+            const qint64 n = qMin(STREAM_CHUNK, size - pos);
+            if (decrypt) xorInto(buffer, data + pos, n);
+            strm.next_in = (Bytef*)(decrypt ? buffer : data + pos);
+            strm.avail_in = uInt(n);
+            pos += n;
+            while (strm.avail_in > 0 && ret == Z_OK) {
+                if (qint64(strm.total_out) == result.size()) result.resize(result.size() * 2);
+                strm.next_out = (Bytef*)(result.data() + strm.total_out);
+                strm.avail_out = uInt(qMin<qint64>(result.size() - strm.total_out, std::numeric_limits<uInt>::max()));
+                ret = inflate(&strm, Z_NO_FLUSH);
+            }
+        }
+        // all input consumed but the last block may still be pending in the window
+        while (ret == Z_OK) {
+            if (qint64(strm.total_out) == result.size()) result.resize(result.size() * 2);
+            strm.next_out = (Bytef*)(result.data() + strm.total_out);
+            strm.avail_out = uInt(qMin<qint64>(result.size() - strm.total_out, std::numeric_limits<uInt>::max()));
+            ret = inflate(&strm, Z_NO_FLUSH);
+        }
+
+        inflateEnd(&strm);
+        // truncated or damaged streams end in Z_BUF_ERROR / Z_DATA_ERROR: no partial data
+        if (ret != Z_STREAM_END) return QByteArray();
+        result.resize(strm.total_out);
+        result.squeeze();
+        return result;
+    }
+}
+
+bool PakArchive::open(const QString& filename, bool memoryMapped, const ProgressFn& progress) {
+    close();
+
+    m_file.setFileName(filename);
+    if (!m_file.open(QIODevice::ReadOnly)) return false;
+
+    QByteArray magic = m_file.peek(4);
+    bool ok = (magic.size() == 4 && readLE<quint32>(magic.constData()) == MAGIC) ? openV2() : openV1(progress);
+    if (!ok) {
+        qDebug() << "[PakArchive] invalid package:" << filename;
+        close();
+        return false;
+    }
+
+    if (memoryMapped && m_version >= 2) {
+        m_map = m_file.map(0, m_file.size());
+        if (!m_map) qDebug() << "[PakArchive] mmap failed, falling back to reads:" << m_file.errorString();
+    }
+    return true;
+}
+
+void PakArchive::close() {
+    // the background hot read uses the file name, the mapping and the hot span
+    m_hotAbort = true;
+    m_hotRead.waitForFinished();
+    m_hotRead = QFuture<void>();
+    m_hotAbort = false;
+
+    if (m_map) {
+        m_file.unmap(const_cast<uchar*>(m_map));
+        m_map = nullptr;
+    }
+    m_file.close();
+    m_version = 0;
+    m_entries.clear();
+    m_index.clear();
+    m_names.clear();
+    m_variants.clear();
+    m_resident.clear();
+    m_recent.clear();
+    m_recentLru.clear();
+    m_recentBytes = 0;
+    m_chunkTables.clear();
+    m_firstChunks.clear();
+    m_integrity.clear();
+    m_hot.clear();
+    m_hotPending.clear();
+    m_hotBegin = m_hotEnd = 0;
+    for (ZSTD_DDict* dict : std::as_const(m_zstdDicts)) ZSTD_freeDDict(dict);
+    m_zstdDicts.clear();
+}
+
+QString PakArchive::variantName(const QString& base, const QSize& size) {
+    return QString("%1@%2x%3").arg(base).arg(size.width()).arg(size.height());
+}
+
+void PakArchive::buildNameLists() {
+    m_names.clear();
+    m_variants.clear();
+    for (int i = 0; i < m_entries.size(); ++i) {
+        const Entry& e = m_entries.at(i);
+        if (e.flags & FlagTombstone) continue;
+        if (!(e.flags & FlagVariant)) {
+            m_names.append(e.name);
+            continue;
+        }
+
+        // "<base>@<w>x<h>"
+        const int at = e.name.lastIndexOf('@');
+        const QStringList dims = e.name.mid(at + 1).split('x');
+        const int base = at > 0 ? indexOf(e.name.left(at)) : -1;
+        if (base < 0 || dims.size() != 2) continue;
+        m_variants[base].append({ QSize(dims[0].toInt(), dims[1].toInt()), i });
+    }
+    m_names.sort();
+    for (auto& list : m_variants) {
+        std::sort(list.begin(), list.end(), [](const Variant& a, const Variant& b) {
+            return a.size.width() < b.size.width();
+        });
+    }
+}
+
+void PakArchive::linkSharedBlobs() {
+    QHash<qint64, int> firstAt; // offset -> first entry stored there
+    for (int i = 0; i < m_entries.size(); ++i) {
+        Entry& e = m_entries[i];
+        auto it = firstAt.constFind(e.offset);
+        if (it == firstAt.constEnd()) {
+            firstAt.insert(e.offset, i);
+            continue;
+        }
+        const Entry& first = m_entries.at(it.value());
+        if (first.storedSize == e.storedSize && first.rawSize == e.rawSize && first.codec == e.codec
+            && (first.flags & FlagXor) == (e.flags & FlagXor)) {
+            e.blob = it.value();
+        }
+    }
+}
+
+void PakArchive::addEntry(const Entry& e) {
+    auto it = m_index.find(e.name);
+    if (it != m_index.end()) {
+        m_entries[it.value()] = e; // later duplicates win, as with the old map
+        return;
+    }
+    m_index.insert(e.name, m_entries.size());
+    m_entries.push_back(e);
+}
+
+bool PakArchive::openV1(const ProgressFn& progress) {
+    // map instead of reading the whole package onto the heap; closing the
+    // file at the end drops the mapping, leaving only the inflated entries
+    const qint64 size = m_file.size();
+    const uchar* map = size > 0 ? m_file.map(0, size) : nullptr;
+    QByteArray all;
+    if (!map) all = m_file.readAll();
+
+    struct Job {
+        QString name;
+        QByteArray encData;
+        QByteArray data;
+    };
+    QVector<Job> jobs;
+
+    const char* p = map ? reinterpret_cast<const char*>(map) : all.constData();
+    const qint64 total = map ? size : all.size();
+    qint64 pos = 0;
+
+    auto readInt = [&](quint32& value) {
+        if (pos + 4 > total) return false;
+        value = readLE<quint32>(p + pos);
+        pos += 4;
+        return true;
+    };
+
+    quint32 fileCount = 0;
+    if (!readInt(fileCount)) return false;
+
+    for (quint32 i = 0; i < fileCount; i++) {
+        quint32 nameLen;
+        if (!readInt(nameLen) || pos + nameLen > total) return false;
+        QString name = QString::fromUtf8(p + pos, nameLen);
+        pos += nameLen;
+
+        quint32 dataLen;
+        if (!readInt(dataLen) || pos + dataLen > total) return false;
+        jobs.push_back({ name, QByteArray::fromRawData(p + pos, dataLen), QByteArray() });
+        pos += dataLen;
+    }
+
+    // v1 has no size table, so each worker still inflates into a growing buffer
+    QAtomicInt done = 0;
+    const int jobCount = jobs.size();
+    QtConcurrent::blockingMap(jobs, [&](Job& job) {
+        job.data = inflateGrowing(job.encData.constData(), job.encData.size(), true);
+        const int n = done.fetchAndAddRelaxed(1) + 1;
+        if (progress) progress(n, jobCount);
+    });
+    m_file.close();
+
+    for (const Job& job : jobs) {
+        if (job.data.isNull()) qDebug() << "[PakArchive] corrupt entry:" << job.name << "in" << fileName();
+        Entry e;
+        e.name = job.name;
+        e.rawSize = job.data.size();
+        addEntry(e);
+        m_resident.insert(indexOf(job.name), job.data);
+    }
+
+    buildNameLists();
+    m_integrity = std::vector<std::atomic<quint8>>(m_entries.size());
+    m_version = 1;
+    return true;
+}
+
+bool PakArchive::openV2() {
+    QByteArray header = m_file.read(HEADER_SIZE);
+    if (header.size() < HEADER_SIZE) return false;
+
+    const char* h = header.constData();
+    const quint32 version = readLE<quint32>(h + 4);
+    const quint32 headerSize = readLE<quint32>(h + 8);
+    const quint32 entryCount = readLE<quint32>(h + 12);
+    const quint64 rawTocOffset = readLE<quint64>(h + 16);
+    const quint64 rawTocSize = readLE<quint64>(h + 24);
+
+    if (version < 2 || version > VERSION || headerSize < HEADER_SIZE) return false;
+    if (!fitsInt64(rawTocOffset) || !fitsInt64(rawTocSize)) return false;
+    const qint64 tocOffset = qint64(rawTocOffset);
+    const qint64 tocSize = qint64(rawTocSize);
+    if (tocOffset < headerSize || tocOffset > m_file.size() || tocSize > m_file.size() - tocOffset) return false;
+
+    if (!m_file.seek(tocOffset)) return false;
+    QByteArray toc = m_file.read(tocSize);
+    if (toc.size() != tocSize) return false;
+
+    const char* p = toc.constData();
+    qint64 pos = 0;
+    for (quint32 i = 0; i < entryCount; i++) {
+        if (pos + RECORD_FIXED_SIZE > toc.size()) return false;
+        const quint32 recordSize = readLE<quint32>(p + pos);
+        const quint16 nameLen = readLE<quint16>(p + pos + 34);
+        if (recordSize < RECORD_FIXED_SIZE + nameLen || pos + recordSize > toc.size()) return false;
+
+        Entry e;
+        e.name = QString::fromUtf8(p + pos + RECORD_FIXED_SIZE, nameLen);
+        const quint64 offset = readLE<quint64>(p + pos + 4);
+        const quint64 storedSize = readLE<quint64>(p + pos + 12);
+        const quint64 rawSize = readLE<quint64>(p + pos + 20);
+        e.flags = readLE<quint32>(p + pos + 28);
+        e.codec = static_cast<quint8>(p[pos + 32]);
+        // data lies between the header and the TOC; compared without adding, so nothing wraps
+        if (!fitsInt64(offset) || !fitsInt64(storedSize)) return false;
+        e.offset = qint64(offset);
+        e.storedSize = qint64(storedSize);
+        if (e.offset < headerSize || e.storedSize > tocOffset || e.offset > tocOffset - e.storedSize) {
+            qDebug() << "[PakArchive] damaged record, data outside the package:" << e.name << offset << storedSize;
+            return false;
+        }
+        // a damaged size must fail the open, not a multi-gigabyte allocation in the decoder
+        if (!fitsInt64(rawSize) || qint64(rawSize) > maxRawSize(e.codec, e.storedSize)) {
+            qDebug() << "[PakArchive] damaged record, decoded size out of range:" << e.name << rawSize;
+            return false;
+        }
+        e.rawSize = qint64(rawSize);
+
+        const char* extra = p + pos + RECORD_FIXED_SIZE + nameLen;
+        const qint64 extraSize = recordSize - RECORD_FIXED_SIZE - nameLen;
+        qint64 extraPos = 0;
+        if (e.flags & FlagTrimmed) {
+            if (extraSize >= TRIM_FIELDS_SIZE) {
+                e.trim.canvas = QSize(int(readLE<quint32>(extra)), int(readLE<quint32>(extra + 4)));
+                e.trim.offset = QPoint(readLE<qint32>(extra + 8), readLE<qint32>(extra + 12));
+            }
+            extraPos += TRIM_FIELDS_SIZE;
+        }
+        if (e.flags & FlagChecksum) {
+            if (extraSize < extraPos + CHECKSUM_FIELD_SIZE) return false;
+            e.crc = readLE<quint32>(extra + extraPos);
+            extraPos += CHECKSUM_FIELD_SIZE;
+        }
+
+        if ((e.flags & FlagHot) && e.storedSize > 0) {
+            if (m_hotEnd == m_hotBegin) m_hotBegin = e.offset;
+            m_hotBegin = qMin(m_hotBegin, e.offset);
+            m_hotEnd = qMax(m_hotEnd, e.offset + e.storedSize);
+            m_hotPending.insert(e.offset);
+        }
+
+        // recordSize covers fields appended by newer packers; skip what we don't know
+        if (e.flags & FlagDictionary) {
+            if (!loadDictionary(e)) return false;
+        }
+        else {
+            addEntry(e);
+        }
+        pos += recordSize;
+    }
+
+    buildNameLists();
+    linkSharedBlobs();
+    m_integrity = std::vector<std::atomic<quint8>>(m_entries.size());
+    m_version = 2;
+    return true;
+}
+
+QByteArray PakArchive::read(int index) {
+    if (index < 0 || index >= m_entries.size()) return QByteArray();
+    if (m_entries.at(index).flags & FlagTombstone) return QByteArray();
+    const int blob = blobOf(index);
+    {
+        QMutexLocker lock(&m_cacheMutex);
+        QByteArray cached;
+        if (findDecoded(blob, &cached)) return cached;
+    }
+
+    const Entry& e = m_entries.at(index);
+    if (isZeroCopy(e)) {
+        // zero-copy: callers read straight from the page cache
+        const QByteArray view = QByteArray::fromRawData(reinterpret_cast<const char*>(m_map + e.offset), e.storedSize);
+        return verify(index, view) ? view : QByteArray();
+    }
+
+    QByteArray data = decode(index);
+    QMutexLocker lock(&m_cacheMutex);
+    keepDecoded(blob, data);
+    return data;
+}
+
+bool PakArchive::findDecoded(int blob, QByteArray* data) {
+    auto resident = m_resident.constFind(blob);
+    if (resident != m_resident.constEnd()) {
+        *data = resident.value();
+        return true;
+    }
+    auto it = m_recent.find(blob);
+    if (it == m_recent.end()) return false;
+    m_recentLru.splice(m_recentLru.begin(), m_recentLru, it->lru);
+    *data = it->data;
+    return true;
+}
+
+void PakArchive::keepDecoded(int blob, const QByteArray& data) {
+    if (data.isEmpty() || data.size() > m_decodedBudget / 8 || m_recent.contains(blob)) return;
+    m_recentLru.push_front(blob);
+    m_recent.insert(blob, { data, m_recentLru.begin() });
+    m_recentBytes += data.size();
+    trimDecoded();
+}
+
+void PakArchive::trimDecoded() {
+    while (m_recentBytes > m_decodedBudget && !m_recentLru.empty()) {
+        const int oldest = m_recentLru.back();
+        m_recentLru.pop_back();
+        m_recentBytes -= m_recent.take(oldest).data.size();
+    }
+}
+
+void PakArchive::setDecodedBudget(qint64 bytes) {
+    QMutexLocker lock(&m_cacheMutex);
+    m_decodedBudget = qMax<qint64>(0, bytes);
+    trimDecoded();
+}
+
+void PakArchive::decodeAll(const ProgressFn& progress) {
+    struct Job {
+        int index;
+        QByteArray data;
+        bool ok = false;
+    };
+    QVector<Job> jobs;
+    {
+        QMutexLocker lock(&m_cacheMutex);
+        for (int i = 0; i < m_entries.size(); ++i) {
+            if (blobOf(i) != i || m_resident.contains(i) || isZeroCopy(m_entries.at(i))) continue;
+            jobs.push_back({ i, QByteArray(decodeCapacity(m_entries.at(i)), Qt::Uninitialized) });
+        }
+    }
+
+    QAtomicInt done = 0;
+    const int total = jobs.size();
+    QtConcurrent::blockingMap(jobs, [&](Job& job) {
+        job.ok = decodeInto(job.index, job.data.data());
+        const int n = done.fetchAndAddRelaxed(1) + 1;
+        if (progress) progress(n, total);
+    });
+
+    QMutexLocker lock(&m_cacheMutex);
+    for (Job& job : jobs) {
+        if (!job.ok) continue;
+        job.data.resize(m_entries.at(job.index).rawSize);
+        if (m_recent.contains(job.index)) {
+            m_recentBytes -= m_recent.value(job.index).data.size();
+            m_recentLru.erase(m_recent.take(job.index).lru);
+        }
+        m_resident.insert(job.index, job.data);
+    }
+}
+
+int PakArchive::verifyAll(const ProgressFn& progress) {
+    QVector<int> blobs;
+    for (int i = 0; i < m_entries.size(); ++i) {
+        if (blobOf(i) != i || !(m_entries.at(i).flags & FlagChecksum)) continue;
+        if (m_integrity[i].load(std::memory_order_acquire) == Unchecked) blobs.push_back(i);
+    }
+
+    QAtomicInt done = 0;
+    const int total = blobs.size();
+    QtConcurrent::blockingMap(blobs, [&](int index) {
+        // checksum only: streamed through the chunk buffer, nothing decoded or kept
+        quint32 crc = 0;
+        if (streamStored(m_entries.at(index), ChunkFn(), &crc)) settle(index, crc);
+        else markCorrupt(index);
+        const int n = done.fetchAndAddRelaxed(1) + 1;
+        if (progress) progress(n, total);
+    });
+
+    int corrupt = 0;
+    for (int i = 0; i < m_entries.size(); ++i) {
+        if (blobOf(i) == i && m_integrity[i].load(std::memory_order_acquire) == Corrupt) ++corrupt;
+    }
+    return corrupt;
+}
+
+bool PakArchive::needsCheck(int index) const {
+    const int blob = blobOf(index);
+    return (m_entries.at(blob).flags & FlagChecksum)
+        && m_integrity[blob].load(std::memory_order_acquire) == Unchecked;
+}
+
+bool PakArchive::verify(int index, const QByteArray& stored) {
+    const quint8 state = m_integrity[blobOf(index)].load(std::memory_order_acquire);
+    if (state == Corrupt) return false;
+    if (!needsCheck(index)) return true;
+    if (stored.size() != m_entries.at(index).storedSize) {
+        markCorrupt(index);
+        return false;
+    }
+    return settle(index, Crc32c::compute(stored.constData(), stored.size()));
+}
+
+bool PakArchive::settle(int index, quint32 crc) {
+    const int blob = blobOf(index);
+    if (crc != m_entries.at(blob).crc) {
+        markCorrupt(index);
+        return false;
+    }
+    quint8 expected = Unchecked;
+    m_integrity[blob].compare_exchange_strong(expected, Intact, std::memory_order_acq_rel);
+    return true;
+}
+
+void PakArchive::markCorrupt(int index) {
+    // report each blob once, even when several threads trip over it
+    if (m_integrity[blobOf(index)].exchange(Corrupt, std::memory_order_acq_rel) == Corrupt) return;
+    qDebug() << "[PakArchive] corrupt entry:" << m_entries.at(index).name << "in" << fileName();
+    if (m_onCorrupt) m_onCorrupt(index);
+}
+
+bool PakArchive::isZeroCopy(const Entry& e) const {
+    return m_map && e.codec == CodecStored && !(e.flags & (FlagXor | FlagChunked));
+}
+
+bool PakArchive::isContiguous(const Entry& e) const {
+    return m_map && !(e.flags & FlagXor);
+}
+
+qint64 PakArchive::decodeCapacity(const Entry& e) const {
+    // lz4 decodes in place: the stored block is streamed into the tail of the
+    // output buffer, which needs a small margin (LZ4_DECOMPRESS_INPLACE_MARGIN)
+    if (e.codec == CodecLz4 && !(e.flags & FlagChunked) && !isContiguous(e) && e.storedSize < e.rawSize) {
+        return e.rawSize + (e.storedSize >> 8) + 32;
+    }
+    return e.rawSize;
+}
+
+bool PakArchive::streamStored(const Entry& e, const ChunkFn& sink, quint32* crc) {
+    const bool decrypt = (e.flags & FlagXor) && sink;
+    char* buffer = chunkBuffer();
+    for (qint64 pos = 0; pos < e.storedSize; ) {
+        const qint64 n = qMin(STREAM_CHUNK, e.storedSize - pos);
+        const char* chunk = buffer;
+        if (m_map && !decrypt) {
+            chunk = reinterpret_cast<const char*>(m_map + e.offset + pos);
+            if (crc) *crc = Crc32c::compute(chunk, n, *crc);
+        }
+        else if (!readStored(e, pos, n, buffer, crc, bool(sink))) {
+            return false;
+        }
+        if (sink && !sink(chunk, n)) return false;
+        pos += n;
+    }
+    return true;
+}
+
+bool PakArchive::readStored(const Entry& e, qint64 pos, qint64 n, char* dst, quint32* crc, bool consume) {
+    if (pos < 0 || n < 0 || pos + n > e.storedSize) return false;
+    const char* src = dst;
+    if (m_map) {
+        src = reinterpret_cast<const char*>(m_map + e.offset + pos);
+    }
+    else if (copyHot(e.offset + pos, n, dst, consume)) {
+        // src == dst: the checksum and XOR below work in place
+    }
+    else {
+        QMutexLocker lock(&m_fileMutex);
+        if (!m_file.seek(e.offset + pos) || m_file.read(dst, n) != n) return false;
+    }
+
+    // the checksum covers the bytes as stored, before the XOR
+    if (crc) *crc = Crc32c::compute(src, n, *crc);
+    if (e.flags & FlagXor) xorInto(dst, src, n);
+    else if (src != dst) memcpy(dst, src, n);
+    return true;
+}
+
+PakArchive::ChunkTable PakArchive::chunkTable(int index) {
+    const int blob = blobOf(index);
+    {
+        QMutexLocker lock(&m_cacheMutex);
+        auto it = m_chunkTables.constFind(blob);
+        if (it != m_chunkTables.constEnd()) return it.value();
+    }
+
+    const Entry& e = m_entries.at(blob);
+    char header[CHUNK_HEADER_SIZE];
+    if (!readStored(e, 0, CHUNK_HEADER_SIZE, header, nullptr)) return ChunkTable();
+    const qint64 chunkSize = readLE<quint32>(header);
+    const qint64 count = readLE<quint32>(header + 4);
+    const qint64 tableEnd = CHUNK_HEADER_SIZE + count * CHUNK_RECORD_SIZE;
+    if (chunkSize <= 0 || tableEnd > e.storedSize || count != (e.rawSize + chunkSize - 1) / chunkSize) {
+        return ChunkTable();
+    }
+
+    QByteArray records(count * CHUNK_RECORD_SIZE, Qt::Uninitialized);
+    if (!readStored(e, CHUNK_HEADER_SIZE, records.size(), records.data(), nullptr)) return ChunkTable();
+
+    ChunkTable table;
+    table.offsets.reserve(count + 1);
+    table.crcs.reserve(count);
+    qint64 pos = tableEnd;
+    for (qint64 i = 0; i < count; ++i) {
+        const char* r = records.constData() + i * CHUNK_RECORD_SIZE;
+        table.offsets.append(pos);
+        table.crcs.append(readLE<quint32>(r + 4));
+        pos += readLE<quint32>(r);
+    }
+    table.offsets.append(pos);
+    if (pos != e.storedSize) return ChunkTable();
+    table.chunkSize = chunkSize;
+
+    QMutexLocker lock(&m_cacheMutex);
+    m_chunkTables.insert(blob, table);
+    return table;
+}
+
+bool PakArchive::decodeChunkInto(int index, const ChunkTable& table, int chunk, char* dst) {
+    const Entry& e = m_entries.at(index);
+    Entry piece = e;
+    piece.offset = e.offset + table.offsets[chunk];
+    piece.storedSize = table.offsets[chunk + 1] - table.offsets[chunk];
+    piece.rawSize = qMin(table.chunkSize, e.rawSize - chunk * table.chunkSize);
+
+    quint32 crc = 0;
+    bool ok = false;
+    if (isContiguous(e)) {
+        const char* stored = reinterpret_cast<const char*>(m_map + piece.offset);
+        crc = Crc32c::compute(stored, piece.storedSize);
+        ok = crc == table.crcs[chunk] && decodeContiguous(piece, stored, dst);
+    }
+    else {
+        QByteArray stored(piece.storedSize, Qt::Uninitialized);
+        ok = readStored(e, table.offsets[chunk], piece.storedSize, stored.data(), &crc)
+            && crc == table.crcs[chunk] && decodeContiguous(piece, stored.constData(), dst);
+    }
+    if (!ok) markCorrupt(index);
+    return ok;
+}
+
+qint64 PakArchive::chunkSize(int index) {
+    if (index < 0 || index >= m_entries.size()) return 0;
+    const Entry& e = m_entries.at(index);
+    if (e.flags & FlagChunked) return chunkTable(index).chunkSize;
+    if (e.codec == CodecStored) return RANGE_CHUNK;
+    return qMax<qint64>(e.rawSize, 1);
+}
+
+QByteArray PakArchive::readChunk(int index, int chunk) {
+    if (index < 0 || index >= m_entries.size() || chunk < 0) return QByteArray();
+    const Entry& e = m_entries.at(index);
+    if (e.flags & FlagTombstone) return QByteArray();
+    if (m_integrity[blobOf(index)].load(std::memory_order_acquire) == Corrupt) return QByteArray();
+
+    if (e.flags & FlagChunked) {
+        const ChunkTable table = chunkTable(index);
+        if (!table.isValid()) {
+            markCorrupt(index);
+            return QByteArray();
+        }
+        if (chunk >= table.crcs.size()) return QByteArray();
+        if (chunk == 0) {
+            QMutexLocker lock(&m_cacheMutex);
+            for (const auto& [blob, data] : std::as_const(m_firstChunks)) {
+                if (blob == blobOf(index)) return data;
+            }
+        }
+        QByteArray data(qMin(table.chunkSize, e.rawSize - chunk * table.chunkSize), Qt::Uninitialized);
+        if (!decodeChunkInto(index, table, chunk, data.data())) return QByteArray();
+        return data;
+    }
+
+    // compressed as a whole: the only chunk is the entry (cached by read())
+    if (e.codec != CodecStored) return chunk == 0 ? read(index) : QByteArray();
+
+    const qint64 pos = chunk * RANGE_CHUNK;
+    if (pos >= e.rawSize) return QByteArray();
+    const qint64 n = qMin(RANGE_CHUNK, e.rawSize - pos);
+    if (isZeroCopy(e)) {
+        return QByteArray::fromRawData(reinterpret_cast<const char*>(m_map + e.offset + pos), n);
+    }
+    QByteArray data(n, Qt::Uninitialized);
+    if (!readStored(e, pos, n, data.data(), nullptr)) return QByteArray();
+    return data;
+}
+
+void PakArchive::prefetchFirstChunk(int index) {
+    if (index < 0 || index >= m_entries.size()) return;
+    const Entry& e = m_entries.at(index);
+    if (!(e.flags & FlagChunked)) {
+        if (e.codec == CodecStored) return;
+        bool kept;
+        {
+            QMutexLocker lock(&m_cacheMutex);
+            kept = e.rawSize <= m_decodedBudget / 8;
+        }
+        // decoding one that read() would not keep only wastes the time
+        if (kept) read(index);
+        return;
+    }
+
+    const int blob = blobOf(index);
+    {
+        QMutexLocker lock(&m_cacheMutex);
+        for (const auto& slot : std::as_const(m_firstChunks)) {
+            if (slot.first == blob) return;
+        }
+    }
+    const QByteArray data = readChunk(index, 0);
+    if (data.isEmpty()) return;
+    QMutexLocker lock(&m_cacheMutex);
+    for (const auto& slot : std::as_const(m_firstChunks)) {
+        if (slot.first == blob) return; // raced with another prefetch
+    }
+    if (m_firstChunks.size() >= FIRST_CHUNK_SLOTS) m_firstChunks.removeFirst();
+    m_firstChunks.append({ blob, data });
+}
+
+QByteArray PakArchive::storedBytes(const Entry& e) {
+    if (m_map) {
+        return QByteArray::fromRawData(reinterpret_cast<const char*>(m_map + e.offset), e.storedSize);
+    }
+    QByteArray stored(e.storedSize, Qt::Uninitialized);
+    if (copyHot(e.offset, e.storedSize, stored.data(), true)) return stored;
+    QMutexLocker lock(&m_fileMutex);
+    if (!m_file.seek(e.offset) || m_file.read(stored.data(), e.storedSize) != e.storedSize) return QByteArray();
+    return stored;
+}
+
+bool PakArchive::copyHot(qint64 offset, qint64 n, char* dst, bool consume) {
+    if (offset < m_hotBegin || offset + n > m_hotEnd) return false;
+    QMutexLocker lock(&m_hotMutex);
+    // a read from the start of a hot blob consumes it, served from here or
+    // not; later reads of it go to the file
+    if (consume) m_hotPending.remove(offset);
+    if (m_hot.isEmpty()) return false;
+    memcpy(dst, m_hot.constData() + (offset - m_hotBegin), n);
+    if (m_hotPending.isEmpty()) m_hot = QByteArray();
+    return true;
+}
+
+void PakArchive::releaseHotPrefix() {
+    QMutexLocker lock(&m_hotMutex);
+    m_hotPending.clear(); // also stops a read still in flight from installing its copy
+    m_hot = QByteArray();
+}
+
+bool PakArchive::readHotPrefix() {
+    const qint64 size = hotSize();
+    if (size <= 0) return true;
+
+    if (m_map) {
+        // the mapping reads through the system cache: have the OS fetch the span, no copy
+        const uchar* begin = m_map + m_hotBegin;
+#if defined(Q_OS_WIN)
+        WIN32_MEMORY_RANGE_ENTRY range{ const_cast<uchar*>(begin), SIZE_T(size) };
+        return PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#elif defined(Q_OS_UNIX)
+        const quintptr page = quintptr(sysconf(_SC_PAGESIZE));
+        const quintptr start = quintptr(begin) & ~(page - 1);
+        return ::madvise(reinterpret_cast<void*>(start), quintptr(begin) + size - start, MADV_WILLNEED) == 0;
+#else
+        return true;
+#endif
+    }
+
+    // own handle: m_file's position belongs to readers holding m_fileMutex
+    QFile file(m_file.fileName());
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(m_hotBegin)) return false;
+    QByteArray hot(size, Qt::Uninitialized);
+    for (qint64 pos = 0; pos < size; pos += HOT_READ_PIECE) {
+        if (m_hotAbort.load(std::memory_order_relaxed)) return false;
+        const qint64 n = qMin(HOT_READ_PIECE, size - pos);
+        if (file.read(hot.data() + pos, n) != n) return false;
+    }
+
+    QMutexLocker lock(&m_hotMutex);
+    if (!m_hotPending.isEmpty()) m_hot = std::move(hot); // else all were read from the file meanwhile
+    return true;
+}
+
+void PakArchive::readHotPrefixAsync() {
+    if (hotSize() <= 0) return;
+    m_hotRead = QtConcurrent::run([this]() {
+        QElapsedTimer timer;
+        timer.start();
+        const bool ok = readHotPrefix();
+        qDebug() << "[PakArchive] hot prefix of" << m_file.fileName() << (ok ? "read:" : "not read:")
+            << hotSize() / 1024 << "KB in" << timer.elapsed() << "ms";
+    });
+}
+
+bool PakArchive::loadDictionary(const Entry& e) {
+    QByteArray bytes = storedBytes(e);
+    if (bytes.size() != e.storedSize || e.codec != CodecStored) return false;
+    if ((e.flags & FlagChecksum) && Crc32c::compute(bytes.constData(), bytes.size()) != e.crc) {
+        qDebug() << "[PakArchive] corrupt zstd dictionary:" << e.name;
+        return false;
+    }
+    if (e.flags & FlagXor) bytes = xorDecrypt(bytes);
+
+    ZSTD_DDict* dict = ZSTD_createDDict(bytes.constData(), bytes.size());
+    if (!dict) return false;
+    const quint32 id = ZSTD_getDictID_fromDDict(dict);
+    if (ZSTD_DDict* old = m_zstdDicts.value(id)) ZSTD_freeDDict(old);
+    m_zstdDicts.insert(id, dict);
+    return true;
+}
+
+QByteArray PakArchive::decode(int index) {
+    const Entry& e = m_entries.at(index);
+    QByteArray data(decodeCapacity(e), Qt::Uninitialized);
+    if (!decodeInto(index, data.data())) return QByteArray();
+    data.resize(e.rawSize); // drops the in-place margin without reallocating
+    return data;
+}
+
+bool PakArchive::decodeInto(int index, char* dst) {
+    if (m_integrity[blobOf(index)].load(std::memory_order_acquire) == Corrupt) return false;
+
+    const Entry& e = m_entries.at(index);
+    if (e.flags & FlagChunked) {
+        // each chunk carries its own checksum; the entry's is left to verifyAll()
+        const ChunkTable table = chunkTable(index);
+        if (!table.isValid()) {
+            markCorrupt(index);
+            return false;
+        }
+        for (int i = 0; i < table.crcs.size(); ++i) {
+            if (!decodeChunkInto(index, table, i, dst + i * table.chunkSize)) return false;
+        }
+        return true;
+    }
+
+    quint32 crcValue = 0;
+    quint32* crc = needsCheck(index) ? &crcValue : nullptr;
+    bool ok = false;
+
+    if (isContiguous(e)) {
+        // mapped and plain: decode straight from the page cache
+        const QByteArray stored = storedBytes(e);
+        if (!verify(index, stored)) return false;
+        crc = nullptr;
+        ok = decodeContiguous(e, stored.constData(), dst);
+    }
+    else {
+        switch (e.codec) {
+        case CodecStored:
+            ok = e.storedSize == e.rawSize && streamToBuffer(e, dst, crc);
+            break;
+        case CodecZlib:
+            ok = inflateStream(e, dst, crc);
+            break;
+        case CodecLz4:
+            if (e.storedSize < e.rawSize) {
+                char* tail = dst + decodeCapacity(e) - e.storedSize;
+                ok = streamToBuffer(e, tail, crc) && decodeContiguous(e, tail, dst);
+            }
+            else {
+                // incompressible block: no room in place, decode from a copy
+                QByteArray stored(e.storedSize, Qt::Uninitialized);
+                ok = streamToBuffer(e, stored.data(), crc) && decodeContiguous(e, stored.constData(), dst);
+            }
+            break;
+        default: {
+            // zstd entries are small dictionary-compressed text; a copy of the
+            // stored frame is cheaper than a streaming context with its window
+            QByteArray stored(e.storedSize, Qt::Uninitialized);
+            ok = streamToBuffer(e, stored.data(), crc) && decodeContiguous(e, stored.constData(), dst);
+            break;
+        }
+        }
+    }
+
+    // a bad checksum wins over whatever the codec made of the bytes
+    if (crc && !settle(index, *crc)) return false;
+    if (!ok) {
+        // no checksum, or the packer wrote bad data: still not worth a crash
+        markCorrupt(index);
+        return false;
+    }
+    return true;
+}
+
+bool PakArchive::streamToBuffer(const Entry& e, char* dst, quint32* crc) {
+    qint64 pos = 0;
+    return streamStored(e, [&](const char* chunk, qint64 n) {
+        memcpy(dst + pos, chunk, n);
+        pos += n;
+        return true;
+    }, crc);
+}
+
+bool PakArchive::inflateStream(const Entry& e, char* dst, quint32* crc) {
+    if (e.rawSize > std::numeric_limits<uInt>::max()) return false;
+
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    if (inflateInit(&strm) != Z_OK) return false;
+    strm.next_out = (Bytef*)dst;
+    strm.avail_out = uInt(e.rawSize);
+
+    int ret = Z_OK;
+    const bool streamed = streamStored(e, [&](const char* chunk, qint64 n) {
+        strm.next_in = (Bytef*)chunk;
+        strm.avail_in = uInt(n);
+        while (strm.avail_in > 0 && ret == Z_OK) ret = inflate(&strm, Z_NO_FLUSH);
+        return ret == Z_OK || ret == Z_STREAM_END;
+    }, crc);
+
+    inflateEnd(&strm);
+    return streamed && ret == Z_STREAM_END && qint64(strm.total_out) == e.rawSize;
+}
+
+bool PakArchive::decodeContiguous(const Entry& e, const char* stored, char* dst) {
+    switch (e.codec) {
+    case CodecStored:
+        if (e.storedSize != e.rawSize) return false;
+        memcpy(dst, stored, e.rawSize);
+        return true;
+    case CodecZlib: {
+        uLongf destLen = static_cast<uLongf>(e.rawSize);
+        return uncompress((Bytef*)dst, &destLen, (const Bytef*)stored, e.storedSize) == Z_OK
+            && destLen == static_cast<uLongf>(e.rawSize);
+    }
+    case CodecLz4:
+        if (e.rawSize > LZ4_MAX_INPUT_SIZE || e.storedSize > LZ4_MAX_INPUT_SIZE) return false;
+        return LZ4_decompress_safe(stored, dst, int(e.storedSize), int(e.rawSize)) == e.rawSize;
+    case CodecZstd: {
+        const quint32 dictId = ZSTD_getDictID_fromFrame(stored, e.storedSize);
+        ZSTD_DDict* dict = dictId ? m_zstdDicts.value(dictId) : nullptr;
+        if (dictId && !dict) {
+            qDebug() << "[PakArchive] missing zstd dictionary:" << dictId << "for" << e.name;
+            return false;
+        }
+        const size_t n = dict
+            ? ZSTD_decompress_usingDDict(zstdContext(), dst, e.rawSize, stored, e.storedSize, dict)
+            : ZSTD_decompressDCtx(zstdContext(), dst, e.rawSize, stored, e.storedSize);
+        return !ZSTD_isError(n) && n == size_t(e.rawSize);
+    }
+    default:
+        qDebug() << "[PakArchive] unknown codec:" << e.codec;
+        return false;
+    }
+}
+
+QByteArray PakArchive::xorDecrypt(const QByteArray& data) {
+    QByteArray out(data.size(), Qt::Uninitialized);
+    xorInto(out.data(), data.constData(), data.size());
+    return out;
+}
+
+QByteArray PakArchive::zlibUncompress(const QByteArray& data) {
+    return inflateGrowing(data.constData(), data.size(), false);
+}
@@ -0,0 +1,231 @@
+#pragma once
+#include <QFile>
+#include <QFuture>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QMutex>
+#include <functional>
+#include <atomic>
+#include <list>
+#include <vector>
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include "SpriteTrim.h"
+
+// resources.pak reader.
+// v1: legacy flat layout, every entry is decoded when the package is opened.
+// v2: header + table of contents, entries are decoded on first read().
+// open() and close() belong to the owning thread; once open, reads may come
+// from any thread, and bulk decoding fans out over QtConcurrent.
+// Codec libraries (zlib, lz4, zstd) come from vcpkg.
+struct ZSTD_DDict_s;
+
+class PakArchive {
+public:
+    using ProgressFn = std::function<void(int done, int total)>;
+    // Called with the entry index, on whichever thread found the damage.
+    using IntegrityFn = std::function<void(int index)>;
+
+    static constexpr quint32 MAGIC = 0x4B504547; // "GEPK"
+    static constexpr quint32 VERSION = 2;
+    static constexpr char XOR_KEY = 0x5A;
+    static constexpr qint64 DEFAULT_DECODED_BUDGET = 16 * 1024 * 1024;
+    static constexpr int FIRST_CHUNK_SLOTS = 8; // prefetchFirstChunk() results kept
+
+    enum EntryFlag : quint32 {
+        FlagXor = 0x1,
+        FlagDictionary = 0x2, // zstd dictionary, not exposed as a resource
+        FlagTrimmed = 0x4,    // sprite with transparent borders cut; record carries the canvas
+        FlagVariant = 0x8,    // down-scaled copy named "<base>@<w>x<h>", hidden from entryNames()
+        FlagTombstone = 0x10, // overlay deletes this name from lower packages; no data
+        FlagChecksum = 0x20,  // record ends with a CRC32C of the stored bytes
+        FlagChunked = 0x40,   // data starts with a chunk table; chunks compressed separately
+        FlagHot = 0x80,       // used at start-up; hot blobs are contiguous at the front of the data
+    };
+
+    enum Codec : quint8 {
+        CodecStored = 0,
+        CodecZlib = 1,
+        CodecLz4 = 2,  // raw LZ4 block
+        CodecZstd = 3, // zstd frame, optionally with a dictionary
+    };
+
+    struct Entry {
+        QString name;
+        qint64 offset = 0;
+        qint64 storedSize = 0;
+        qint64 rawSize = 0;
+        quint32 flags = 0;
+        quint8 codec = CodecStored;
+        SpriteTrim trim;
+        int blob = -1; // first entry with the same stored bytes (packer dedup, one decoded buffer); -1 = itself
+        quint32 crc = 0; // CRC32C of the stored bytes when FlagChecksum is set
+    };
+
+    struct Variant {
+        QSize size;
+        int index = -1;
+    };
+
+    PakArchive() = default;
+    ~PakArchive() { close(); }
+    PakArchive(const PakArchive&) = delete;
+    PakArchive& operator=(const PakArchive&) = delete;
+
+    bool open(const QString& filename, bool memoryMapped = false, const ProgressFn& progress = ProgressFn());
+    void close();
+    bool isOpen() const { return m_version != 0; }
+    bool isMapped() const { return m_map != nullptr; }
+    int version() const { return m_version; }
+    QString fileName() const { return m_file.fileName(); }
+
+    // Entries are addressed by a stable index; resolve names once with indexOf().
+    int indexOf(const QString& name) const { return m_index.value(name, -1); }
+    bool contains(const QString& name) const { return m_index.contains(name); }
+    int entryCount() const { return m_entries.size(); }
+    const Entry& entry(int index) const { return m_entries.at(index); }
+    // Returns a copy the caller owns; empty if the entry is corrupt (reported
+    // once through the integrity handler). Memory-mapped stored entries come
+    // back as views over the mapping, valid until close(). Other v2 blobs are
+    // decoded straight into a buffer of the recorded raw size and kept only in
+    // a small LRU, so images and audio are not held twice; v1 keeps everything.
+    QByteArray read(const QString& name) { return read(indexOf(name)); }
+    QByteArray read(int index);
+    QStringList entryNames() const { return m_names; } // sorted
+    SpriteTrim trimOf(int index) const {
+        return (index >= 0 && index < m_entries.size()) ? m_entries.at(index).trim : SpriteTrim();
+    }
+    // Pre-scaled variants of an image entry, smallest first.
+    QVector<Variant> variantsOf(int index) const { return m_variants.value(index); }
+    static QString variantName(const QString& base, const QSize& size);
+
+    // Decode every entry not yet cached, in parallel, into preallocated buffers
+    // that stay resident until close().
+    void decodeAll(const ProgressFn& progress = ProgressFn());
+    // Bytes of recently decoded blobs kept for repeated reads; blobs over an
+    // eighth of it are never kept.
+    void setDecodedBudget(qint64 bytes);
+
+    // Piecewise access for streaming. Chunked entries use their packed chunks
+    // (each checked against its own CRC32C), stored entries any 256 KB range
+    // (not checksummed), anything else is one chunk decoded by read().
+    // The last chunk may be shorter; readChunk() is empty past the end.
+    qint64 chunkSize(int index);
+    QByteArray readChunk(int index, int chunk);
+    // Decodes the first chunk ahead of a PakEntryDevice opening the entry, so
+    // playback starts without a decode. Chunked entries keep it among the
+    // last FIRST_CHUNK_SLOTS prefetched; entries compressed as a whole are
+    // decoded only if small enough for the LRU above; stored ones need nothing.
+    void prefetchFirstChunk(int index);
+
+    // Set before the archive is shared with other threads.
+    void setIntegrityHandler(const IntegrityFn& handler) { m_onCorrupt = handler; }
+    // FlagChecksum blobs are checked once, on first read or here.
+    // Checksums every entry not yet verified, in parallel; returns the number
+    // of corrupt entries (including ones found earlier by read()).
+    int verifyAll(const ProgressFn& progress = ProgressFn());
+
+    // Packers given an access trace lay entries out in first-use order and flag
+    // the start-up set FlagHot. Bytes spanned by those entries; 0 if none.
+    qint64 hotSize() const { return m_hotEnd - m_hotBegin; }
+    // Fetches the hot span in one sequential pass. Mapped packages only ask
+    // the OS to page it in (madvise / PrefetchVirtualMemory). Unmapped ones
+    // keep a copy that serves those entries' stored bytes and is released
+    // once every hot blob has been read (verifyAll() does not count) or by
+    // releaseHotPrefix(). Safe while read() runs on other threads; call at
+    // most once.
+    bool readHotPrefix();
+    // Drops the unmapped copy, e.g. once start-up is over; later reads go to the file.
+    void releaseHotPrefix();
+    // readHotPrefix() on the global thread pool; close() stops and waits for it.
+    void readHotPrefixAsync();
+
+    static QByteArray xorDecrypt(const QByteArray& data);
+    static QByteArray zlibUncompress(const QByteArray& data);
+
+private:
+    bool openV1(const ProgressFn& progress);
+    bool openV2();
+    void addEntry(const Entry& e);
+    void buildNameLists();
+    void linkSharedBlobs();
+    int blobOf(int index) const {
+        const int blob = m_entries.at(index).blob;
+        return blob < 0 ? index : blob;
+    }
+    bool isZeroCopy(const Entry& e) const;
+    bool isContiguous(const Entry& e) const; // mapped and not XORed: decode from the mapping
+    qint64 decodeCapacity(const Entry& e) const; // buffer size decodeInto() needs
+    QByteArray decode(int index);
+    bool decodeInto(int index, char* dst);
+    bool decodeContiguous(const Entry& e, const char* stored, char* dst);
+    bool inflateStream(const Entry& e, char* dst, quint32* crc);
+    bool streamToBuffer(const Entry& e, char* dst, quint32* crc);
+    // Feeds the stored bytes in chunks, XOR-decoded unless `sink` is empty;
+    // `crc`, if given, accumulates over the bytes as stored.
+    using ChunkFn = std::function<bool(const char* data, qint64 size)>;
+    bool streamStored(const Entry& e, const ChunkFn& sink, quint32* crc);
+    // XOR-decoded stored bytes [pos, pos + n) of an entry into dst.
+    // `consume` = false for checksum-only reads, which leave the hot prefix's
+    // bookkeeping alone.
+    bool readStored(const Entry& e, qint64 pos, qint64 n, char* dst, quint32* crc, bool consume = true);
+
+    struct ChunkTable {
+        qint64 chunkSize = 0; // decoded bytes per chunk
+        QVector<qint64> offsets; // stored offset of each chunk, plus the end
+        QVector<quint32> crcs;
+        bool isValid() const { return chunkSize > 0; }
+    };
+    ChunkTable chunkTable(int index); // invalid if the table is damaged
+    bool decodeChunkInto(int index, const ChunkTable& table, int chunk, char* dst);
+    bool needsCheck(int index) const;
+    bool verify(int index, const QByteArray& stored);
+    bool settle(int index, quint32 crc);
+    void markCorrupt(int index);
+    QByteArray storedBytes(const Entry& e);
+    // Copies stored bytes [offset, offset + n) from the hot prefix; false if
+    // the range is outside it or the copy is not (or no longer) held.
+    // Unmapped packages only.
+    bool copyHot(qint64 offset, qint64 n, char* dst, bool consume);
+    bool loadDictionary(const Entry& e);
+
+    QFile m_file;
+    const uchar* m_map = nullptr;
+    int m_version = 0;
+    QVector<Entry> m_entries;
+    QHash<QString, int> m_index;
+    QStringList m_names;
+    QHash<int, QVector<Variant>> m_variants; // base entry -> variants
+
+    QMutex m_cacheMutex;
+    QMutex m_fileMutex;
+    QHash<int, QByteArray> m_resident; // by blobOf(index): v1 entries, decodeAll()
+    struct Recent {
+        QByteArray data;
+        std::list<int>::iterator lru;
+    };
+    QHash<int, Recent> m_recent; // by blobOf(index)
+    std::list<int> m_recentLru; // front = most recently used
+    qint64 m_recentBytes = 0;
+    qint64 m_decodedBudget = DEFAULT_DECODED_BUDGET;
+    bool findDecoded(int blob, QByteArray* data); // m_cacheMutex held
+    void keepDecoded(int blob, const QByteArray& data); // m_cacheMutex held
+    void trimDecoded(); // m_cacheMutex held
+    QHash<int, ChunkTable> m_chunkTables; // by blobOf(index)
+    QVector<QPair<int, QByteArray>> m_firstChunks; // by blobOf(index), oldest first
+
+    enum Integrity : quint8 { Unchecked, Intact, Corrupt };
+    std::vector<std::atomic<quint8>> m_integrity; // by blobOf(index)
+    IntegrityFn m_onCorrupt;
+    QHash<quint32, ZSTD_DDict_s*> m_zstdDicts; // by dictionary id, read-only after open
+
+    qint64 m_hotBegin = 0;
+    qint64 m_hotEnd = 0;
+    QMutex m_hotMutex;
+    QByteArray m_hot; // [m_hotBegin, m_hotEnd) once read, unmapped packages only
+    QSet<qint64> m_hotPending; // offsets of hot blobs not read yet
+    QFuture<void> m_hotRead;
+    std::atomic<bool> m_hotAbort{ false };
+};
@@ -0,0 +1,66 @@
+#include "PakEntryDevice.h"
+#include "PakArchive.h"
+#include <cstring>
+
+PakEntryDevice::PakEntryDevice(PakArchive* pak, int index, QObject* parent)
+    : QIODevice(parent), m_pak(pak), m_index(index) {
+}
+
+bool PakEntryDevice::open(OpenMode mode) {
+    if (mode & WriteOnly) {
+        setErrorString("PakEntryDevice is read-only");
+        return false;
+    }
+    if (!m_pak || m_index < 0 || m_index >= m_pak->entryCount()) {
+        setErrorString("no such package entry");
+        return false;
+    }
+    m_chunkSize = m_pak->chunkSize(m_index);
+    if (m_chunkSize <= 0) {
+        setErrorString("damaged package entry");
+        return false;
+    }
+    m_size = m_pak->entry(m_index).rawSize;
+    m_chunk = -1;
+    m_data.clear();
+    return QIODevice::open(mode | Unbuffered);
+}
+
+void PakEntryDevice::close() {
+    QIODevice::close();
+    m_chunk = -1;
+    m_data.clear();
+}
+
+qint64 PakEntryDevice::readData(char* data, qint64 maxSize) {
+    // unbuffered, so pos() is where this read starts
+    qint64 pos = this->pos();
+    qint64 done = 0;
+    while (done < maxSize && pos < m_size) {
+        const int chunk = int(pos / m_chunkSize);
+        if (chunk != m_chunk) {
+            m_data = m_pak->readChunk(m_index, chunk);
+            if (m_data.isEmpty()) {
+                // corrupt: reported by the archive; end the stream here
+                m_chunk = -1;
+                setErrorString("damaged package entry");
+                return done > 0 ? done : -1;
+            }
+            m_chunk = chunk;
+        }
+
+        const qint64 offset = pos - qint64(chunk) * m_chunkSize;
+        const qint64 n = qMin(maxSize - done, qint64(m_data.size()) - offset);
+        if (n <= 0) break;
+        std::memcpy(data + done, m_data.constData() + offset, n);
+        done += n;
+        pos += n;
+    }
+    return done;
+}
+
+qint64 PakEntryDevice::writeData(const char* data, qint64 maxSize) {
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
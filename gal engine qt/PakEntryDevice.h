@@ -0,0 +1,34 @@
+#pragma once
+#include <QIODevice>
+#include <QByteArray>
+
+class PakArchive;
+
+// Read-only, seekable view of one package entry for consumers that stream
+// (QMediaPlayer). Reads decode the chunk under the current position through
+// PakArchive::readChunk() and keep only that chunk, so a long BGM starts at
+// once and stays a few hundred KB resident instead of fully decoded.
+// The archive must stay mounted while the device is open.
+class PakEntryDevice : public QIODevice {
+    Q_OBJECT
+public:
+    PakEntryDevice(PakArchive* pak, int index, QObject* parent = nullptr);
+
+    // ReadOnly only; always unbuffered, the current chunk is the buffer.
+    bool open(OpenMode mode) override;
+    void close() override;
+    bool isSequential() const override { return false; }
+    qint64 size() const override { return m_size; }
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+    PakArchive* m_pak;
+    int m_index;
+    qint64 m_size = 0;
+    qint64 m_chunkSize = 0;
+    int m_chunk = -1;
+    QByteArray m_data; // decoded chunk m_chunk
+};
@@ -0,0 +1,92 @@
+#include "PakStack.h"
+#include <QDebug>
+
+int PakStack::mount(const QString& filename, int priority, bool memoryMapped, const PakArchive::ProgressFn& progress) {
+    // open and parse outside the lock; readers keep going on the mounted packages
+    auto pak = std::make_unique<PakArchive>();
+    if (m_onCorrupt) {
+        pak->setIntegrityHandler([handler = m_onCorrupt, p = pak.get()](int index) {
+            handler(p->fileName(), p->entry(index).name);
+        });
+    }
+    if (!pak->open(filename, memoryMapped, progress)) return -1;
+
+    QWriteLocker lock(&m_lock);
+    const int id = int(m_mounts.size());
+    for (int i = 0; i < pak->entryCount(); ++i) {
+        const PakArchive::Entry& e = pak->entry(i);
+        auto it = m_index.find(e.name);
+        if (it != m_index.end() && m_mounts[it->ref.pak].priority > priority) continue;
+        m_index.insert(e.name, { { id, i }, (e.flags & PakArchive::FlagTombstone) != 0 });
+    }
+    m_mounts.push_back({ std::move(pak), priority });
+
+    m_names.clear();
+    for (auto it = m_index.cbegin(); it != m_index.cend(); ++it) {
+        if (it->tombstone) continue;
+        if (m_mounts[it->ref.pak].pak->entry(it->ref.index).flags & PakArchive::FlagVariant) continue;
+        m_names.append(it.key());
+    }
+    m_names.sort();
+    return id;
+}
+
+void PakStack::unmountAll() {
+    QWriteLocker lock(&m_lock);
+    m_index.clear();
+    m_names.clear();
+    m_mounts.clear();
+}
+
+bool PakStack::isEmpty() const {
+    QReadLocker lock(&m_lock);
+    return m_mounts.empty();
+}
+
+PakArchive* PakStack::archive(int pak) const {
+    QReadLocker lock(&m_lock);
+    return (pak >= 0 && pak < int(m_mounts.size())) ? m_mounts[pak].pak.get() : nullptr;
+}
+
+PakStack::Ref PakStack::resolve(const QString& name) const {
+    QReadLocker lock(&m_lock);
+    auto it = m_index.constFind(name);
+    if (it == m_index.constEnd() || it->tombstone) return Ref();
+    return it->ref;
+}
+
+QByteArray PakStack::read(const Ref& ref) const {
+    PakArchive* pak = ref.isValid() ? archive(ref.pak) : nullptr;
+    return pak ? pak->read(ref.index) : QByteArray();
+}
+
+SpriteTrim PakStack::trimOf(const Ref& ref) const {
+    PakArchive* pak = ref.isValid() ? archive(ref.pak) : nullptr;
+    return pak ? pak->trimOf(ref.index) : SpriteTrim();
+}
+
+QVector<PakArchive::Variant> PakStack::variantsOf(const Ref& ref) const {
+    PakArchive* pak = ref.isValid() ? archive(ref.pak) : nullptr;
+    return pak ? pak->variantsOf(ref.index) : QVector<PakArchive::Variant>();
+}
+
+QString PakStack::fileName(const Ref& ref) const {
+    PakArchive* pak = ref.isValid() ? archive(ref.pak) : nullptr;
+    return pak ? pak->fileName() : QString();
+}
+
+QStringList PakStack::entryNames() const {
+    QReadLocker lock(&m_lock);
+    return m_names;
+}
+
+int PakStack::verifyAll(const PakArchive::ProgressFn& progress) const {
+    QVector<PakArchive*> paks;
+    {
+        QReadLocker lock(&m_lock);
+        for (const Mount& m : m_mounts) paks.append(m.pak.get());
+    }
+    int corrupt = 0;
+    for (PakArchive* pak : paks) corrupt += pak->verifyAll(progress);
+    return corrupt;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "PakArchive.h"
+
+// Several packages mounted at once: the base resources.pak plus patch / DLC
+// overlays. A name resolves through one merged index to the entry of the
+// highest-priority package that has it (later mounts win ties); data is never
+// copied between packages. A tombstone entry hides the name from everything
+// mounted below it. mount() opens only the new package and merges its table
+// of contents, so overlays can be attached while the game runs.
+// Lookups and reads may run on any thread; mounting takes a write lock.
+class PakStack {
+public:
+    struct Ref {
+        int pak = -1;
+        int index = -1;
+        bool isValid() const { return pak >= 0 && index >= 0; }
+        bool operator==(const Ref& o) const { return pak == o.pak && index == o.index; }
+        bool operator!=(const Ref& o) const { return !(*this == o); }
+    };
+
+    // Package file name and entry name of a corrupt entry; may run on any thread.
+    using IntegrityFn = std::function<void(const QString& package, const QString& entry)>;
+
+    PakStack() = default;
+    PakStack(const PakStack&) = delete;
+    PakStack& operator=(const PakStack&) = delete;
+
+    // Applies to packages mounted afterwards.
+    void setIntegrityHandler(const IntegrityFn& handler) { m_onCorrupt = handler; }
+
+    // Returns the mount id, or -1 if the package cannot be opened.
+    int mount(const QString& filename, int priority, bool memoryMapped = false,
+        const PakArchive::ProgressFn& progress = PakArchive::ProgressFn());
+    void unmountAll();
+
+    bool isEmpty() const;
+    // Valid until unmountAll(); mount ids are stable.
+    PakArchive* archive(int pak) const;
+
+    Ref resolve(const QString& name) const;
+    bool contains(const QString& name) const { return resolve(name).isValid(); }
+
+    QByteArray read(const Ref& ref) const;
+    QByteArray read(const QString& name) const { return read(resolve(name)); }
+    SpriteTrim trimOf(const Ref& ref) const;
+    QVector<PakArchive::Variant> variantsOf(const Ref& ref) const;
+    QString fileName(const Ref& ref) const;
+
+    // Visible resource names across all mounts, sorted; no variants or tombstones.
+    QStringList entryNames() const;
+
+    // Checksums every mounted package (PakArchive::verifyAll), one after the
+    // other; returns the number of corrupt entries. Blocks, so run it off the
+    // GUI thread; don't unmountAll() meanwhile.
+    int verifyAll(const PakArchive::ProgressFn& progress = PakArchive::ProgressFn()) const;
+
+private:
+    struct Mount {
+        std::unique_ptr<PakArchive> pak;
+        int priority = 0;
+    };
+    struct Winner {
+        Ref ref;
+        bool tombstone = false;
+    };
+
+    mutable QReadWriteLock m_lock;
+    std::vector<Mount> m_mounts;
+    QHash<QString, Winner> m_index;
+    QStringList m_names;
+    IntegrityFn m_onCorrupt;
+};
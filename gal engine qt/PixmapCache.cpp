@@ -0,0 +1,105 @@
+#include "PixmapCache.h"
+
+PixmapCache::PixmapCache(qint64 budgetBytes) : m_budget(budgetBytes) {
+    m_scaled.setMaxCost(budgetBytes / SCALED_BUDGET_SHARE);
+}
+
+void PixmapCache::setBudget(qint64 bytes) {
+    m_budget = bytes;
+    m_scaled.setMaxCost(bytes / SCALED_BUDGET_SHARE);
+    evict();
+}
+
+QPixmap PixmapCache::find(AssetId key) {
+    auto it = m_nodes.find(key);
+    if (it == m_nodes.end()) {
+        m_stats.misses++;
+        return QPixmap();
+    }
+    m_stats.hits++;
+    m_lru.splice(m_lru.begin(), m_lru, it->lru);
+    return it->pixmap;
+}
+
+void PixmapCache::insert(AssetId key, const QPixmap& px) {
+    if (px.isNull()) return;
+    removeNode(key);
+
+    Node node;
+    node.pixmap = px;
+    node.cost = costOf(px);
+    m_lru.push_front(key);
+    node.lru = m_lru.begin();
+    m_nodes.insert(key, node);
+    m_bytes += node.cost;
+
+    evict();
+}
+
+void PixmapCache::remove(AssetId key) {
+    for (const ScaledKey& k : m_scaled.keys()) {
+        if (k.id == key) m_scaled.remove(k);
+    }
+    removeNode(key);
+}
+
+void PixmapCache::removeNode(AssetId key) {
+    auto it = m_nodes.find(key);
+    if (it == m_nodes.end()) return;
+    m_bytes -= it->cost;
+    m_lru.erase(it->lru);
+    m_nodes.erase(it);
+}
+
+void PixmapCache::clear() {
+    m_nodes.clear();
+    m_lru.clear();
+    m_scaled.clear();
+    m_bytes = 0;
+}
+
+QPixmap PixmapCache::findScaled(AssetId key, const QSize& size) {
+    const QPixmap* px = m_scaled.object({ key, size });
+    return px ? *px : QPixmap();
+}
+
+void PixmapCache::insertScaled(AssetId key, const QSize& size, const QPixmap& px) {
+    if (px.isNull()) return;
+    m_scaled.insert({ key, size }, new QPixmap(px), costOf(px));
+}
+
+void PixmapCache::pin(AssetId key) {
+    if (key == INVALID_ASSET) return;
+    m_pins[key]++;
+}
+
+void PixmapCache::unpin(AssetId key) {
+    auto it = m_pins.find(key);
+    if (it == m_pins.end()) return;
+    if (--it.value() <= 0) m_pins.erase(it);
+    evict();
+}
+
+PixmapCache::Stats PixmapCache::stats() const {
+    Stats s = m_stats;
+    s.bytes = m_bytes;
+    s.budget = m_budget;
+    s.count = m_nodes.size();
+    s.pinned = m_pins.size();
+    return s;
+}
+
+void PixmapCache::evict() {
+    // walk from the cold end, skipping whatever is pinned
+    auto it = m_lru.end();
+    while (m_bytes > m_budget && it != m_lru.begin()) {
+        --it;
+        if (isPinned(*it)) continue;
+
+        auto node = m_nodes.find(*it);
+        m_bytes -= node->cost;
+        m_nodes.erase(node);
+        it = m_lru.erase(it);
+        m_stats.evictions++;
+    }
+}
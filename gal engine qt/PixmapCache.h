@@ -0,0 +1,76 @@
+#pragma once
+#include <QPixmap>
+#include <QHash>
+#include <QCache>
+#include <list>
+#include "AssetId.h"
+
+// Byte-budgeted LRU cache for decoded pixmaps. Cost is width * height * depth.
+// Pinned keys (the assets currently on screen) are never evicted; a key may be
+// pinned before its pixmap is inserted. Downscaled copies live in a separate,
+// smaller LRU keyed by (asset, size). GUI thread only.
+class PixmapCache {
+public:
+    struct Stats {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 evictions = 0;
+        qint64 bytes = 0;
+        qint64 budget = 0;
+        int count = 0;
+        int pinned = 0;
+    };
+
+    explicit PixmapCache(qint64 budgetBytes = 256LL * 1024 * 1024);
+
+    void setBudget(qint64 bytes);
+    qint64 budget() const { return m_budget; }
+
+    bool contains(AssetId key) const { return m_nodes.contains(key); }
+    QPixmap find(AssetId key);
+    void insert(AssetId key, const QPixmap& px);
+    // Drops the scaled copies of the asset too.
+    void remove(AssetId key);
+    void clear();
+
+    QPixmap findScaled(AssetId key, const QSize& size);
+    void insertScaled(AssetId key, const QSize& size, const QPixmap& px);
+
+    void pin(AssetId key);
+    void unpin(AssetId key);
+    bool isPinned(AssetId key) const { return m_pins.value(key) > 0; }
+
+    Stats stats() const;
+
+    static qint64 costOf(const QPixmap& px) {
+        return qint64(px.width()) * px.height() * px.depth() / 8;
+    }
+
+private:
+    struct Node {
+        QPixmap pixmap;
+        qint64 cost = 0;
+        std::list<AssetId>::iterator lru;
+    };
+
+    struct ScaledKey {
+        AssetId id;
+        QSize size;
+        bool operator==(const ScaledKey& o) const { return id == o.id && size == o.size; }
+        friend size_t qHash(const ScaledKey& k, size_t seed = 0) noexcept {
+            return qHashMulti(seed, k.id, k.size.width(), k.size.height());
+        }
+    };
+    static constexpr int SCALED_BUDGET_SHARE = 8; // scaled copies get budget / 8
+
+    void removeNode(AssetId key);
+    void evict();
+
+    QHash<AssetId, Node> m_nodes;
+    QCache<ScaledKey, QPixmap> m_scaled;
+    std::list<AssetId> m_lru; // front = most recently used
+    QHash<AssetId, int> m_pins;
+    qint64 m_budget;
+    qint64 m_bytes = 0;
+    Stats m_stats;
+};
@@ -0,0 +1,189 @@
+#include "QoiImage.h"
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+    constexpr int HEADER_SIZE = 14;
+    constexpr int PADDING_SIZE = 8; // 7 x 0x00, 0x01
+    constexpr quint32 MAX_PIXELS = 400000000;
+
+    constexpr uchar OP_INDEX = 0x00;
+    constexpr uchar OP_DIFF = 0x40;
+    constexpr uchar OP_LUMA = 0x80;
+    constexpr uchar OP_RUN = 0xc0;
+    constexpr uchar OP_RGB = 0xfe;
+    constexpr uchar OP_RGBA = 0xff;
+    constexpr uchar MASK_2 = 0xc0;
+
+    struct Px {
+        uchar r = 0, g = 0, b = 0, a = 255;
+        bool operator==(const Px& o) const { return r == o.r && g == o.g && b == o.b && a == o.a; }
+    };
+
+    inline int hashOf(const Px& p) {
+        return (p.r * 3 + p.g * 5 + p.b * 7 + p.a * 11) % 64;
+    }
+
+    inline QRgb premultiplied(const Px& p) {
+        if (p.a == 255) return qRgb(p.r, p.g, p.b);
+        return qPremultiply(qRgba(p.r, p.g, p.b, p.a));
+    }
+}
+
+namespace QoiImage {
+    bool isQoi(const QByteArray& data) {
+        return data.size() >= HEADER_SIZE + PADDING_SIZE && std::memcmp(data.constData(), "qoif", 4) == 0;
+    }
+
+    QImage decode(const QByteArray& data) {
+        if (!isQoi(data)) return QImage();
+
+        const uchar* bytes = reinterpret_cast<const uchar*>(data.constData());
+        const quint32 width = qFromBigEndian<quint32>(bytes + 4);
+        const quint32 height = qFromBigEndian<quint32>(bytes + 8);
+        const uchar channels = bytes[12];
+        if (width == 0 || height == 0 || (channels != 3 && channels != 4)) return QImage();
+        if (width > MAX_PIXELS / height) return QImage();
+
+        QImage image(int(width), int(height), channels == 4 ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32);
+        if (image.isNull()) return QImage();
+
+        const uchar* p = bytes + HEADER_SIZE;
+        // every op reads at most 5 bytes, and the 8-byte padding keeps that in bounds
+        const uchar* end = bytes + data.size() - PADDING_SIZE;
+
+        Px index[64];
+        std::memset(index, 0, sizeof(index));
+        Px px;
+        QRgb out = premultiplied(px);
+        int run = 0;
+
+        for (quint32 y = 0; y < height; ++y) {
+            QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(int(y)));
+            for (quint32 x = 0; x < width; ++x) {
+                if (run > 0) {
+                    --run;
+                }
+                else if (p < end) {
+                    const uchar b1 = *p++;
+                    if (b1 == OP_RGB) {
+                        px.r = p[0]; px.g = p[1]; px.b = p[2];
+                        p += 3;
+                    }
+                    else if (b1 == OP_RGBA) {
+                        px.r = p[0]; px.g = p[1]; px.b = p[2]; px.a = p[3];
+                        p += 4;
+                    }
+                    else if ((b1 & MASK_2) == OP_INDEX) {
+                        px = index[b1];
+                    }
+                    else if ((b1 & MASK_2) == OP_DIFF) {
+                        px.r += ((b1 >> 4) & 0x03) - 2;
+                        px.g += ((b1 >> 2) & 0x03) - 2;
+                        px.b += (b1 & 0x03) - 2;
+                    }
+                    else if ((b1 & MASK_2) == OP_LUMA) {
+                        const uchar b2 = *p++;
+                        const int vg = (b1 & 0x3f) - 32;
+                        px.r += vg - 8 + ((b2 >> 4) & 0x0f);
+                        px.g += vg;
+                        px.b += vg - 8 + (b2 & 0x0f);
+                    }
+                    else { // OP_RUN
+                        run = b1 & 0x3f;
+                    }
+                    index[hashOf(px)] = px;
+                    out = premultiplied(px);
+                }
+                line[x] = out;
+            }
+        }
+        return image;
+    }
+
+    QByteArray encode(const QImage& source) {
+        if (source.isNull()) return QByteArray();
+        const QImage image = source.convertToFormat(QImage::Format_ARGB32);
+        const quint32 width = image.width();
+        const quint32 height = image.height();
+        const uchar channels = source.hasAlphaChannel() ? 4 : 3;
+
+        // worst case: one RGBA op per pixel
+        QByteArray data(HEADER_SIZE + qint64(width) * height * 5 + PADDING_SIZE, Qt::Uninitialized);
+        uchar* bytes = reinterpret_cast<uchar*>(data.data());
+        std::memcpy(bytes, "qoif", 4);
+        qToBigEndian<quint32>(width, bytes + 4);
+        qToBigEndian<quint32>(height, bytes + 8);
+        bytes[12] = channels;
+        bytes[13] = 0; // sRGB with linear alpha
+
+        uchar* p = bytes + HEADER_SIZE;
+        Px index[64];
+        std::memset(index, 0, sizeof(index));
+        Px prev;
+        int run = 0;
+        const quint64 last = quint64(width) * height - 1;
+        quint64 n = 0;
+
+        for (quint32 y = 0; y < height; ++y) {
+            const QRgb* line = reinterpret_cast<const QRgb*>(image.constScanLine(int(y)));
+            for (quint32 x = 0; x < width; ++x, ++n) {
+                Px px;
+                px.r = uchar(qRed(line[x]));
+                px.g = uchar(qGreen(line[x]));
+                px.b = uchar(qBlue(line[x]));
+                px.a = channels == 4 ? uchar(qAlpha(line[x])) : 255;
+
+                if (px == prev) {
+                    ++run;
+                    if (run == 62 || n == last) {
+                        *p++ = OP_RUN | (run - 1);
+                        run = 0;
+                    }
+                    continue;
+                }
+                if (run > 0) {
+                    *p++ = OP_RUN | (run - 1);
+                    run = 0;
+                }
+
+                const int h = hashOf(px);
+                if (index[h] == px) {
+                    *p++ = OP_INDEX | h;
+                }
+                else {
+                    index[h] = px;
+                    if (px.a == prev.a) {
+                        const signed char vr = px.r - prev.r;
+                        const signed char vg = px.g - prev.g;
+                        const signed char vb = px.b - prev.b;
+                        const signed char vgr = vr - vg;
+                        const signed char vgb = vb - vg;
+                        if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+                            *p++ = OP_DIFF | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2);
+                        }
+                        else if (vgr > -9 && vgr < 8 && vg > -33 && vg < 32 && vgb > -9 && vgb < 8) {
+                            *p++ = OP_LUMA | (vg + 32);
+                            *p++ = (vgr + 8) << 4 | (vgb + 8);
+                        }
+                        else {
+                            *p++ = OP_RGB;
+                            *p++ = px.r; *p++ = px.g; *p++ = px.b;
+                        }
+                    }
+                    else {
+                        *p++ = OP_RGBA;
+                        *p++ = px.r; *p++ = px.g; *p++ = px.b; *p++ = px.a;
+                    }
+                }
+                prev = px;
+            }
+        }
+
+        static const uchar padding[PADDING_SIZE] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+        std::memcpy(p, padding, PADDING_SIZE);
+        p += PADDING_SIZE;
+        data.truncate(p - bytes);
+        return data;
+    }
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include <QImage>
+#include <QByteArray>
+
+// QOI ("Quite OK Image", qoiformat.org): lossless, PNG-sized for flat game art,
+// and decodes several times faster since there is no inflate or filtering.
+// Decoding writes straight into a premultiplied QImage (RGB32 for 3-channel
+// files), which is what Qt paints with.
+namespace QoiImage {
+    bool isQoi(const QByteArray& data);
+    QImage decode(const QByteArray& data);
+    QByteArray encode(const QImage& image);
+}
@@ -0,0 +1,63 @@
+#include "RawImage.h"
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+    template <typename T>
+    T readLE(const char* p) {
+        return qFromLittleEndian<T>(reinterpret_cast<const uchar*>(p));
+    }
+
+    void releaseBlob(void* info) {
+        delete static_cast<QByteArray*>(info);
+    }
+}
+
+namespace RawImage {
+    bool isRawImage(const QByteArray& data) {
+        return data.size() >= HEADER_SIZE && readLE<quint32>(data.constData()) == MAGIC;
+    }
+
+    QImage fromData(const QByteArray& data) {
+        if (!isRawImage(data)) return QImage();
+
+        const char* h = data.constData();
+        const quint16 version = readLE<quint16>(h + 4);
+        const quint16 headerSize = readLE<quint16>(h + 6);
+        const quint32 width = readLE<quint32>(h + 8);
+        const quint32 height = readLE<quint32>(h + 12);
+        const quint32 format = readLE<quint32>(h + 16);
+        const quint32 bytesPerLine = readLE<quint32>(h + 20);
+
+        if (version != VERSION || headerSize < HEADER_SIZE) return QImage();
+        if (format != QImage::Format_ARGB32_Premultiplied && format != QImage::Format_RGB32) return QImage();
+        if (width == 0 || height == 0 || bytesPerLine < width * 4) return QImage();
+        if (headerSize + qint64(bytesPerLine) * height > data.size()) return QImage();
+
+        // the copy only bumps the refcount (or re-wraps the mapping for fromRawData views)
+        auto* keep = new QByteArray(data);
+        return QImage(reinterpret_cast<const uchar*>(keep->constData() + headerSize),
+            int(width), int(height), int(bytesPerLine), QImage::Format(format), releaseBlob, keep);
+    }
+
+    QByteArray toData(const QImage& source) {
+        if (source.isNull()) return QByteArray();
+        const QImage image = source.convertToFormat(
+            source.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32);
+        const quint32 bytesPerLine = quint32(image.width()) * 4;
+
+        QByteArray data(HEADER_SIZE + qint64(bytesPerLine) * image.height(), '\0');
+        uchar* h = reinterpret_cast<uchar*>(data.data());
+        qToLittleEndian<quint32>(MAGIC, h);
+        qToLittleEndian<quint16>(VERSION, h + 4);
+        qToLittleEndian<quint16>(HEADER_SIZE, h + 6);
+        qToLittleEndian<quint32>(image.width(), h + 8);
+        qToLittleEndian<quint32>(image.height(), h + 12);
+        qToLittleEndian<quint32>(image.format(), h + 16);
+        qToLittleEndian<quint32>(bytesPerLine, h + 20);
+        for (int y = 0; y < image.height(); ++y) {
+            std::memcpy(h + HEADER_SIZE + qint64(y) * bytesPerLine, image.constScanLine(y), bytesPerLine);
+        }
+        return data;
+    }
+}
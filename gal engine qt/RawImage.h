@@ -0,0 +1,24 @@
+#pragma once
+#include <QImage>
+#include <QByteArray>
+
+// Pre-decoded image blob written by packer.py --raw-images.
+// Layout (little-endian):
+//   magic u32 "GEIM", version u16, headerSize u16, width u32, height u32,
+//   format u32 (QImage::Format), bytesPerLine u32, then pixel rows padded to
+//   headerSize (32) so rows stay aligned inside a mapped package.
+// Pixels are already in the format Qt paints with, so loading is a wrap, not a decode.
+namespace RawImage {
+    constexpr quint32 MAGIC = 0x4D494547; // "GEIM"
+    constexpr quint16 VERSION = 1;
+    constexpr int HEADER_SIZE = 32;
+
+    bool isRawImage(const QByteArray& data);
+
+    // Wraps the pixel rows without copying; the QImage keeps `data` alive.
+    // Returns a null image if the blob is malformed.
+    QImage fromData(const QByteArray& data);
+
+    // Same layout as the packer writes; used by tools and benchmarks.
+    QByteArray toData(const QImage& image);
+}
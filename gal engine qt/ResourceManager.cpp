@@ -4,69 +4,203 @@
 #include <QDir>
 #include <QDebug>
 #include <QTextStream>
-#include <QDirIterator>
-#include <zlib.h>
-
-ResourceManager::ResourceManager(QObject* parent) : QObject(parent) {}
+#include <QThreadPool>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QBuffer>
+#include "PakEntryDevice.h"
+#include "Trace.h"
+
+ResourceManager::ResourceManager(QObject* parent) : QObject(parent) {
+    m_io = new IoQueue(this);
+    m_io->setCacheBudget(IO_CACHE_BUDGET);
+    m_decoder = new ImageDecodeQueue([this](AssetId id) { return getData(id); }, this);
+    m_telemetry.setEnabled(RECORD_ASSET_TELEMETRY);
+    m_decoder->setDecodeObserver([this](AssetId id, qint64 ns, const QImage& image) {
+        m_telemetry.recordDecode(id, ns, image.sizeInBytes());
+    });
+    connect(m_decoder, &ImageDecodeQueue::decoded, this, &ResourceManager::onImageDecoded);
+    connect(m_decoder, &ImageDecodeQueue::failed, this, [this](AssetId id) {
+        qDebug() << "Failed to load image:" << assetPath(id);
+        deliverPixmap(id, QPixmap());
+    });
+    // 뱻ȡʱԹŵĵȴ߻صͼһֱȥ
+    connect(m_decoder, &ImageDecodeQueue::cancelled, this, [this](AssetId id) {
+        deliverPixmap(id, QPixmap());
+    });
+    // ڶȡĿĹ߳ϷշŶӻصԼ߳
+    m_paks.setIntegrityHandler([this](const QString& package, const QString& entry) {
+        emit integrityError(package, entry);
+    });
+}
 
 ResourceManager& ResourceManager::instance() {
     static ResourceManager inst;
     return inst;
 }
 
+bool ResourceManager::mountDirectory(const QString& dir) {
+    if (!QFileInfo(dir).isDir()) return false;
+    m_vfs.mount(normalizePath(dir), std::make_shared<HostBackend>(dir), LOOSE_VFS_PRIORITY);
+    {
+        // פԴܸĿ¼ṩ½·
+        QWriteLocker lock(&m_assetLock);
+        for (AssetSlot& slot : m_assets) resolveSlot(slot);
+    }
+    qDebug() << "[ResourceManager] directory mounted:" << dir;
+    return true;
+}
+
+void ResourceManager::verifyPackages() {
+    QThreadPool::globalInstance()->start([this]() {
+        QElapsedTimer timer;
+        timer.start();
+        const int corrupt = m_paks.verifyAll();
+        qDebug() << "[ResourceManager] packages verified in" << timer.elapsed() << "ms, corrupt entries:" << corrupt;
+        emit packagesVerified(corrupt);
+    });
+}
+
 bool ResourceManager::loadPackage(const QString& filename) {
-    if (!USE_PACKED_RESOURCES) return true; // ģʽ
+    return mountPackage(filename, BASE_PACKAGE_PRIORITY);
+}
 
-    QFile f(filename);
-    if (!f.open(QIODevice::ReadOnly)) return false;
-    QByteArray all = f.readAll();
-    f.close();
-
-    const uchar* p = (const uchar*)all.constData();
-    int pos = 0;
-
-    auto readInt = [&](int& value) {
-        if (pos + 4 > all.size()) return false;
-        value = *(int*)(p + pos);
-        pos += 4;
-        return true;
-    };
+bool ResourceManager::mountPackage(const QString& filename, int priority) {
+    auto progress = [this](int done, int total) { emit packageProgress(done, total); };
+
+    const int mount = m_paks.mount(filename, priority, USE_MEMORY_MAPPED_PAK, progress);
+    if (mount < 0) return false;
+    PakArchive* pak = m_paks.archive(mount);
+    if (DECODE_PACKAGE_ON_LOAD) pak->decodeAll(progress);
+    // ʼ¼ŹİʱõĿڿͷ̨һ˳룻жʱɰԼȴ
+    pak->readHotPrefixAsync();
+    if (pak->hotSize() > 0 && !pak->isMapped()) {
+        // ¼Ծɰ汾ʱĿòʱǿͷţж
+        QTimer::singleShot(HOT_PREFIX_HOLD_MS, this, [this, mount, pak]() {
+            if (m_paks.archive(mount) == pak) pak->releaseHotPrefix();
+        });
+    }
 
-    int fileCount = 0;
-    if (!readInt(fileCount)) return false;
+    // аһ VFS ˣϲ PakStack ά
+    if (!m_pakBackend) {
+        m_pakBackend = std::make_shared<PakBackend>(m_paks);
+        m_vfs.mount(QString(), m_pakBackend, PACKAGE_VFS_PRIORITY);
+    }
+    else {
+        m_vfs.refresh(m_pakBackend.get());
+    }
 
-    for (int i = 0; i < fileCount; i++) {
-        int nameLen;
-        if (!readInt(nameLen)) return false;
-        QByteArray name((const char*)(p + pos), nameLen);
-        pos += nameLen;
+    // פ id ֲ䣬ֻ½Ŀ°ǻɾԴɻ
+    QVector<AssetId> changed;
+    {
+        QWriteLocker lock(&m_assetLock);
+        for (AssetId id = 0; id < m_assets.size(); ++id) {
+            const PakStack::Ref old = m_assets[id].pak;
+            resolveSlot(m_assets[id]);
+            if (m_assets[id].pak != old) changed.append(id);
+        }
+    }
+    for (AssetId id : changed) m_pixmapCache.remove(id);
 
-        int dataLen;
-        if (!readInt(dataLen)) return false;
-        QByteArray encData((const char*)(p + pos), dataLen);
-        pos += dataLen;
+    qDebug() << "[ResourceManager] package mounted:" << filename << "priority:" << priority
+        << "version:" << pak->version() << "mapped:" << pak->isMapped() << "changed assets:" << changed.size();
+    return true;
+}
 
-        QByteArray decData = xorDecrypt(encData);
-        QByteArray uncompressed = zlibUncompress(decData);
+void ResourceManager::resolveSlot(AssetSlot& slot) const {
+    const QString name = normalizePath(slot.path);
+    slot.local = m_vfs.localPath(name);
+    slot.pak = m_paks.resolve(name);
+    slot.trim = m_paks.trimOf(slot.pak);
+    slot.variants = m_paks.variantsOf(slot.pak);
+}
 
-        m_resources.insert(QString::fromUtf8(name), uncompressed);
+AssetId ResourceManager::assetId(const QString& path) const {
+    if (path.isEmpty()) return INVALID_ASSET;
+    {
+        QReadLocker lock(&m_assetLock);
+        auto it = m_assetIds.constFind(path);
+        if (it != m_assetIds.constEnd()) return it.value();
     }
-    return true;
+
+    QWriteLocker lock(&m_assetLock);
+    auto it = m_assetIds.constFind(path);
+    if (it != m_assetIds.constEnd()) return it.value();
+
+    AssetSlot slot;
+    slot.path = path;
+    resolveSlot(slot);
+    const AssetId id = m_assets.size();
+    m_assets.append(slot);
+    m_assetIds.insert(path, id);
+    return id;
+}
+
+AssetId ResourceManager::findAssetId(const QString& path) const {
+    QReadLocker lock(&m_assetLock);
+    return m_assetIds.value(path, INVALID_ASSET);
+}
+
+QString ResourceManager::assetPath(AssetId id) const {
+    QReadLocker lock(&m_assetLock);
+    if (id < 0 || id >= m_assets.size()) return QString();
+    return m_assets.at(id).path;
+}
+
+SpriteTrim ResourceManager::spriteTrim(AssetId id) const {
+    QReadLocker lock(&m_assetLock);
+    if (id < 0 || id >= m_assets.size()) return SpriteTrim();
+    return m_assets.at(id).trim;
 }
 
 void ResourceManager::preloadImage(const QString& path) {
-    if (path.isEmpty()) return;
-    if (m_pixmaps.contains(path)) return;
+    //  GUI ̣߳ɺ󷢳 imageLoaded
+    prefetchImage(assetId(path), ImageDecodeQueue::Speculative);
+}
 
-    QPixmap px;
-    QByteArray data = getData(path);
-    if (!data.isEmpty() && px.loadFromData(data)) {
-        m_pixmaps.insert(path, px);
-        emit imageLoaded(path);
-    }
-    else {
-        qDebug() << "Failed to load image:" << path;
+void ResourceManager::prefetchImage(AssetId id, ImageDecodeQueue::Priority priority) {
+    if (id == INVALID_ASSET) return;
+    if (m_pixmapCache.contains(id)) return;
+    readAhead(id, true);
+    m_decoder->request(id, priority);
+}
+
+void ResourceManager::readAhead(AssetId id, bool cache) {
+    // ֻԴϵԴĿӳ䣬 I/O ߳
+    QString local;
+    {
+        QReadLocker lock(&m_assetLock);
+        if (id >= 0 && id < m_assets.size()) local = m_assets.at(id).local;
     }
+    if (local.isEmpty()) return;
+    if (cache) m_io->prefetch({ local });
+    else m_io->advise({ local });
+}
+
+void ResourceManager::cancelPrefetch(AssetId id) {
+    if (m_pendingPixmaps.contains(id)) return;
+    m_decoder->cancel(id);
+}
+
+void ResourceManager::prefetchAudio(AssetId id) {
+    if (id == INVALID_ASSET) return;
+    registerAudio(assetPath(id));
+
+    // ϵƵɲԼȡֻʾϵͳԤĿǰһ飬PakEntryDevice ʱֱ
+    // ԤȡĿһ黺ֻмλҪȡظɰԼ
+    readAhead(id, false);
+    if (!isPacked()) return;
+    QThreadPool::globalInstance()->start([this, id]() {
+        PakStack::Ref ref;
+        {
+            QReadLocker lock(&m_assetLock);
+            if (id < m_assets.size()) ref = m_assets.at(id).pak;
+        }
+        // ֻһ飬νѹһֱפڴ
+        PakArchive* pak = ref.isValid() ? m_paks.archive(ref.pak) : nullptr;
+        if (pak) pak->prefetchFirstChunk(ref.index);
+    });
 }
 
 void ResourceManager::preloadImages(const QStringList& paths) {
@@ -74,24 +208,304 @@ void ResourceManager::preloadImages(const QStringList& paths) {
 }
 
 QPixmap ResourceManager::getPixmap(const QString& path) const {
-    auto it = m_pixmaps.find(path);
-    if (it != m_pixmaps.end()) {
-        return it.value();
+    return getPixmap(assetId(path));
+}
+
+QPixmap ResourceManager::getPixmap(AssetId id) const {
+    QPixmap cached = m_pixmapCache.find(id);
+    if (!cached.isNull()) {
+        m_telemetry.recordHit(id);
+        return cached;
     }
 
-    QPixmap px;
-    QByteArray data = getData(path);
-    if (!data.isEmpty() && px.loadFromData(data)) {
-        const_cast<ResourceManager*>(this)->m_pixmaps.insert(path, px);
+    // δУڵ߳ͬȡ룬ƽʱΪɼ
+    m_telemetry.recordMiss(id);
+    AssetTelemetry::StallTimer stall(m_telemetry, id);
+    QPixmap px = decodePixmap(id);
+    if (!px.isNull()) {
+        m_pixmapCache.insert(id, px);
+        // ͬʱ˳첽ȴߣȽȡʱûеȴ߿֪ͨ
+        auto* self = const_cast<ResourceManager*>(this);
+        self->deliverPixmap(id, px);
+        self->m_decoder->cancel(id);
         return px;
     }
 
-    qDebug() << "Failed to get pixmap:" << path;
+    qDebug() << "Failed to get pixmap:" << assetPath(id);
     return QPixmap();
 }
 
+QPixmap ResourceManager::decodePixmap(AssetId id) const {
+    const QByteArray data = getData(id);
+    QElapsedTimer timer;
+    timer.start();
+    const QImage image = ImageDecodeQueue::decode(data);
+    m_telemetry.recordDecode(id, timer.nsecsElapsed(), image.sizeInBytes());
+    return QPixmap::fromImage(image);
+}
+
+QPixmap ResourceManager::getPixmap(const QString& path, const QSize& targetSize) const {
+    return getPixmap(assetId(path), targetSize);
+}
+
+QPixmap ResourceManager::getPixmap(AssetId id, const QSize& targetSize) const {
+    if (id == INVALID_ASSET || targetSize.isEmpty()) return getPixmap(id);
+
+    auto fits = [&](const QPixmap& px) {
+        return px.width() <= targetSize.width() && px.height() <= targetSize.height();
+    };
+    auto scaled = [&](const QPixmap& px) {
+        return fits(px) ? px : px.scaled(targetSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    };
+
+    const AssetId variant = pickVariant(id, targetSize);
+    if (variant != id) return scaled(getPixmap(variant));
+
+    // ûԤŰ汾Žԭͼ, ߴ磩ŽС棬ԭͼ档
+    // ͳƼԭͼ£ʼ¼ְֻʵڵĿ
+    QPixmap cached = m_pixmapCache.findScaled(id, targetSize);
+    if (!cached.isNull()) {
+        m_telemetry.recordHit(id);
+        return cached;
+    }
+
+    m_telemetry.recordMiss(id);
+    AssetTelemetry::StallTimer stall(m_telemetry, id);
+    QPixmap px = m_pixmapCache.find(id);
+    if (px.isNull()) px = decodePixmap(id);
+    if (px.isNull()) {
+        qDebug() << "Failed to get pixmap:" << assetPath(id);
+        return QPixmap();
+    }
+    px = scaled(px);
+    m_pixmapCache.insertScaled(id, targetSize, px);
+    return px;
+}
+
+AssetId ResourceManager::pickVariant(AssetId id, const QSize& targetSize) const {
+    QString path;
+    QVector<PakArchive::Variant> variants;
+    {
+        QReadLocker lock(&m_assetLock);
+        if (id < 0 || id >= m_assets.size()) return id;
+        path = m_assets.at(id).path;
+        variants = m_assets.at(id).variants;
+    }
+
+    // ͬһ߱£һ߲СĿ꼴ɵȱҪŴ
+    for (const auto& v : variants) {
+        if (v.size.width() >= targetSize.width() || v.size.height() >= targetSize.height()) {
+            return assetId(PakArchive::variantName(path, v.size));
+        }
+    }
+    return id;
+}
+
+ThumbnailCache& ResourceManager::thumbnails() {
+    if (!m_thumbnails) {
+        m_thumbnails = new ThumbnailCache("cache/thumbnails.bin",
+            [this](const QString& path, const QSize& box) { return thumbnailSource(path, box); },
+            [this](const QString& path) { return sourceStamp(path); }, this);
+    }
+    return *m_thumbnails;
+}
+
+// VFS ɺ˸ļԴԴʧЧ
+// VFS ֮ļ浵ͼ
+ThumbnailCache::Stamp ResourceManager::sourceStamp(const QString& path) const {
+    const Vfs::Stat st = m_vfs.stat(normalizePath(path));
+    if (st.isValid()) return { st.mtime, st.size };
+
+    const QFileInfo info(path);
+    if (!info.exists()) return ThumbnailCache::Stamp();
+    return { info.lastModified().toMSecsSinceEpoch(), info.size() };
+}
+
+// ̵߳ãļֱӶ I/O ̵ֽ߳ڻ棨ͼԴֻһΣüԴ
+// 浵ͼҲפ idԴȡõԤŰ汾
+QByteArray ResourceManager::thumbnailSource(const QString& path, const QSize& box) const {
+    const QString local = localFilePath(path);
+    if (!local.isEmpty()) {
+        QFile f(local);
+        return f.open(QIODevice::ReadOnly) ? f.readAll() : QByteArray();
+    }
+    return getData(pickVariant(assetId(path), box));
+}
+
+void ResourceManager::getPixmapAsync(AssetId id, ImageDecodeQueue::Priority priority,
+    QObject* context, PixmapCallback callback) {
+    QPixmap cached = m_pixmapCache.find(id);
+    if (!cached.isNull() || id == INVALID_ASSET) {
+        m_telemetry.recordHit(id);
+        if (callback) callback(cached);
+        return;
+    }
+
+    m_telemetry.recordMiss(id);
+    m_pendingPixmaps[id].append({ context, std::move(callback) });
+    m_decoder->request(id, priority);
+}
+
+void ResourceManager::cancelPixmapAsync(AssetId id, QObject* context) {
+    auto it = m_pendingPixmaps.find(id);
+    if (it == m_pendingPixmaps.end()) return;
+
+    it->removeIf([context](const PendingPixmap& p) { return p.context == context; });
+    if (it->isEmpty()) {
+        m_pendingPixmaps.erase(it);
+        m_decoder->setPriority(id, ImageDecodeQueue::Speculative);
+    }
+}
+
+void ResourceManager::cancelDecode(AssetId id) {
+    // еȴ߶صͼԤͼʱĻصȡһ
+    m_decoder->cancel(id);
+    deliverPixmap(id, QPixmap());
+}
+
+void ResourceManager::prewarm(const QStringList& extraImages, const QStringList& extraAudio) {
+    if (!PREWARM_HOT_SET) return;
+    HotSet hot;
+    hot.load(HOT_SET_FILE);
+
+    QSet<AssetId> queued;
+    for (const auto& item : std::as_const(m_prewarm)) queued.insert(item.id);
+    qint64 bytes = 0;
+    auto add = [&](const QString& path, bool audio, qint64 size) {
+        const AssetId id = assetId(path);
+        if (id == INVALID_ASSET || queued.contains(id) || !exists(path)) return;
+        if (!audio && bytes + size > PREWARM_PIXMAP_BUDGET) return;
+        if (!audio) bytes += size;
+        queued.insert(id);
+        m_prewarm.append({ id, audio });
+    };
+    for (const QString& path : extraImages) add(path, false, 0);
+    for (const QString& path : extraAudio) add(path, true, 0);
+    for (const auto& e : hot.entries()) add(e.path, e.audio, e.bytes);
+
+    qDebug() << "[ResourceManager] prewarming" << m_prewarm.size() << "assets," << bytes / 1024 << "KB of pixmaps";
+    if (!m_prewarming) prewarmNext();
+}
+
+void ResourceManager::prewarmNext() {
+    m_prewarming = false;
+    while (!m_prewarm.isEmpty()) {
+        const PrewarmItem item = m_prewarm.takeFirst();
+        if (item.audio) {
+            prefetchAudio(item.id);
+            continue;
+        }
+        if (m_pixmapCache.contains(item.id)) continue;
+
+        // Լһȴߣɻʧܶصȡһ
+        m_prewarming = true;
+        m_pendingPixmaps[item.id].append({ this, [this](const QPixmap&) { prewarmNext(); } });
+        prefetchImage(item.id, ImageDecodeQueue::Speculative);
+        return;
+    }
+}
+
+bool ResourceManager::saveHotSet() const {
+    if (!PREWARM_HOT_SET || !m_telemetry.isEnabled()) return false;
+
+    QVector<HotSet::Entry> session;
+    for (const auto& [id, r] : m_telemetry.snapshot()) {
+        const QString path = assetPath(id);
+        const QString name = normalizePath(path);
+        if (!m_vfs.exists(name) && !m_paks.resolve(name).isValid()) continue;
+        // űJSON ֻ棬ڴ
+        const bool audio = m_audioPaths.contains(path);
+        const quint64 accesses = audio ? r.opens : r.hits + r.misses;
+        if (accesses == 0) continue;
+
+        HotSet::Entry e;
+        e.path = path;
+        e.audio = audio;
+        e.score = double(accesses);
+        e.bytes = r.decodes ? r.decodedBytes / qint64(r.decodes) : 0;
+        session.append(e);
+    }
+
+    HotSet hot;
+    hot.load(HOT_SET_FILE);
+    hot.update(session);
+    qDebug() << "[ResourceManager] hot set:" << hot.entries().size() << "assets ->" << HOT_SET_FILE;
+    return hot.save(HOT_SET_FILE);
+}
+
+void ResourceManager::onImageDecoded(AssetId id, const QImage& image) {
+    QPixmap px = QPixmap::fromImage(image);
+    m_pixmapCache.insert(id, px);
+    emit imageLoaded(assetPath(id));
+    deliverPixmap(id, px);
+}
+
+void ResourceManager::deliverPixmap(AssetId id, const QPixmap& px) {
+    const QList<PendingPixmap> pending = m_pendingPixmaps.take(id);
+    for (const auto& p : pending) {
+        if (p.context && p.callback) p.callback(px);
+    }
+}
+
 bool ResourceManager::hasPixmap(const QString& path) const {
-    return m_pixmaps.contains(path);
+    return hasPixmap(assetId(path));
+}
+
+bool ResourceManager::hasPixmap(AssetId id) const {
+    return m_pixmapCache.contains(id);
+}
+
+void ResourceManager::setPixmapCacheBudget(qint64 bytes) {
+    m_pixmapCache.setBudget(bytes);
+}
+
+void ResourceManager::pinPixmap(AssetId id) {
+    m_pixmapCache.pin(id);
+}
+
+void ResourceManager::unpinPixmap(AssetId id) {
+    m_pixmapCache.unpin(id);
+}
+
+PixmapCache::Stats ResourceManager::pixmapCacheStats() const {
+    return m_pixmapCache.stats();
+}
+
+bool ResourceManager::dumpTelemetry(const QString& filename) const {
+    const AssetTelemetry::Record t = m_telemetry.total();
+    qDebug() << "[ResourceManager] telemetry:" << t.hits << "hits," << t.misses << "misses,"
+        << t.stalls << "stalls," << t.stallNs / 1000000 << "ms stalled ->" << filename;
+    return m_telemetry.dump(filename, [this](AssetId id) { return assetPath(id); });
+}
+
+bool ResourceManager::writeAccessTrace(const QString& filename) const {
+    QFile f(filename);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) return false;
+
+    QTextStream out(&f);
+    out << "# GalEngine access trace: first use (ms), resource path; for packer.py --order\n";
+    int written = 0;
+    int audio = 0;
+    for (const auto& [path, ms] : m_telemetry.accessOrder([this](AssetId id) { return assetPath(id); })) {
+        const QString name = normalizePath(path);
+        // ֻԴ浵ͼȲ VFS Դ
+        if (!m_vfs.exists(name) && !m_paks.resolve(name).isValid()) continue;
+        out << ms << '\t' << name << '\n';
+        ++written;
+        if (m_audioPaths.contains(path)) ++audio;
+    }
+    qDebug() << "[ResourceManager] access trace:" << written << "assets," << audio << "audio ->" << filename;
+
+    // ŹƵڼ¼ʱֽ
+    int played = 0;
+    for (const QString& path : m_audioPaths) {
+        const AssetId id = findAssetId(path);
+        if (id != INVALID_ASSET && m_telemetry.record(id).opens > 0) ++played;
+    }
+    if (played > 0 && audio == 0) {
+        qWarning() << "[ResourceManager] access trace has no audio although" << played << "audio assets were played";
+    }
+    return true;
 }
 
 void ResourceManager::registerAudio(const QString& path) {
@@ -99,6 +513,14 @@ void ResourceManager::registerAudio(const QString& path) {
     m_audioPaths.insert(path);
 }
 
+AssetId ResourceManager::recordAudioOpen(const QString& path) {
+    if (path.isEmpty()) return INVALID_ASSET;
+    registerAudio(path);
+    const AssetId id = assetId(path);
+    m_telemetry.recordOpen(id);
+    return id;
+}
+
 bool ResourceManager::hasAudio(const QString& path) const {
     return m_audioPaths.contains(path);
 }
@@ -137,19 +559,55 @@ QString ResourceManager::loadTextFile(const QString& path) const {
     return QString::fromUtf8(data);
 }
 
-QByteArray ResourceManager::getData(const QString& path) const {
-    if (USE_PACKED_RESOURCES) {
-        qDebug() << "[ResourceManager] lookup:" << path << "normalized:" << normalizePath(path)
-            << "exists:" << m_resources.contains(normalizePath(path));
-        return m_resources.value(normalizePath(path));
+QByteArray ResourceManager::getData(AssetId id) const {
+    AssetSlot slot;
+    {
+        QReadLocker lock(&m_assetLock);
+        if (id < 0 || id >= m_assets.size()) return QByteArray();
+        slot = m_assets.at(id);
     }
-    else {
-        QFile f(path);
-        if (!f.open(QIODevice::ReadOnly)) return QByteArray();
-        qDebug() << "[ResourceManager] lookup:" << path << "normalized:" << normalizePath(path)
-            << "exists:" << m_resources.contains(normalizePath(path));
-        return f.readAll();
+
+    GE_TRACE_DEBUG(lcResource) << "lookup:" << slot.path << "pak:" << slot.pak.pak << "entry:" << slot.pak.index;
+    AssetTelemetry::StallTimer stall(m_telemetry, id);
+    QElapsedTimer timer;
+    timer.start();
+    // ĿפʱѽֱӶȡٲ VFS 
+    const QByteArray data = slot.pak.isValid() ? m_paks.read(slot.pak) : readData(slot.path);
+    m_telemetry.recordRead(id, timer.nsecsElapsed(), data.size());
+    return data;
+}
+
+QByteArray ResourceManager::getData(const QString& path) const {
+    if (!m_telemetry.isEnabled()) return readData(path);
+    // פԴ id ǣࣨű浵ͼ·ǣΪͳפ id
+    const AssetId id = findAssetId(path);
+    QElapsedTimer timer;
+    if (id != INVALID_ASSET) {
+        AssetTelemetry::StallTimer stall(m_telemetry, id);
+        timer.start();
+        const QByteArray data = readData(path);
+        m_telemetry.recordRead(id, timer.nsecsElapsed(), data.size());
+        return data;
     }
+    AssetTelemetry::StallTimer stall(m_telemetry, path);
+    timer.start();
+    const QByteArray data = readData(path);
+    m_telemetry.recordRead(path, timer.nsecsElapsed(), data.size());
+    return data;
+}
+
+QByteArray ResourceManager::readData(const QString& path) const {
+    const QString name = normalizePath(path);
+    GE_TRACE_DEBUG(lcResource) << "lookup:" << path << "normalized:" << name;
+    // ϵԴ I/O ̵ֽ߳ڻȡͬһļĲֻһ
+    const QString local = m_vfs.localPath(name);
+    if (!local.isEmpty()) return m_io->read(local);
+    if (m_vfs.exists(name)) return m_vfs.read(name);
+
+    // VFS ֮⣺浵ͼûѡĽűļ
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) return QByteArray();
+    return f.readAll();
 }
 
 QString ResourceManager::normalizePath(const QString& path) const {
@@ -166,96 +624,48 @@ QString ResourceManager::normalizePath(const QString& path) const {
     return p;
 }
 
-QByteArray ResourceManager::xorDecrypt(const QByteArray& data) const {
-    QByteArray out = data;
-    for (int i = 0; i < out.size(); i++) {
-        out[i] = out[i] ^ 0x5A;
-    }
-    return out;
+bool ResourceManager::exists(const QString& path) const {
+    return m_vfs.exists(normalizePath(path)) || QFileInfo::exists(path);
 }
 
-QByteArray ResourceManager::zlibUncompress(const QByteArray& data) const {
-    QByteArray result;
-    int bufferSize = 1024 * 1024;
-    result.resize(bufferSize);
-
-    z_stream strm;
-    memset(&strm, 0, sizeof(strm));
-    inflateInit(&strm);
-
-    strm.next_in = (Bytef*)data.data();
-    strm.avail_in = data.size();
-
-    int ret;
-    do {
-        strm.next_out = (Bytef*)(result.data() + strm.total_out);
-        strm.avail_out = result.size() - strm.total_out;
-        ret = inflate(&strm, Z_NO_FLUSH);
-
-        if (ret == Z_BUF_ERROR || strm.avail_out == 0) {
-            result.resize(result.size() * 2);
-            continue;
-        }
-        if (ret == Z_STREAM_END) break;
-    } while (ret == Z_OK);
-
-    inflateEnd(&strm);
-    result.resize(strm.total_out);
-    return result;
+QString ResourceManager::localFilePath(const QString& path) const {
+    const QString name = normalizePath(path);
+    if (m_vfs.exists(name)) return m_vfs.localPath(name);
+    return QFileInfo::exists(path) ? path : QString();
 }
-QFileInfoList ResourceManager::getFileList(const QString& directory,
-    const QStringList& filters,
-    bool recursive) {
-    QFileInfoList result;
-
-    if (USE_PACKED_RESOURCES) {
-        // ԴģʽѼصԴв
-        QString normalizedDir = normalizePath(directory);
-        if (!normalizedDir.endsWith('/')) {
-            normalizedDir += '/';
-        }
 
-        // Դƥļ
-        for (auto it = m_resources.keyBegin(); it != m_resources.keyEnd(); ++it) {
-            QString filePath = *it;
-
-            // ǷָĿ¼
-            if (filePath.startsWith(normalizedDir)) {
-                // Ƿƥ
-                if (filters.isEmpty() ||
-                    QDir::match(filters, QFileInfo(filePath).fileName())) {
-                    // QFileInfoע⣺Դģʽ£ЩϢܲ
-                    QFileInfo fileInfo;
-                    fileInfo.setFile(filePath); // ֻļ·
-                    result.append(fileInfo);
-                }
-            }
-        }
+QIODevice* ResourceManager::openStream(const QString& path, QObject* parent) const {
+    const AssetId id = assetId(path);
+    m_telemetry.recordOpen(id);
+    AssetTelemetry::StallTimer stall(m_telemetry, id);
+    QIODevice* device = nullptr;
+    const QString local = localFilePath(path);
+    const PakStack::Ref ref = local.isEmpty() ? m_paks.resolve(normalizePath(path)) : PakStack::Ref();
+    if (!local.isEmpty()) {
+        device = new QFile(local, parent);
+    }
+    else if (ref.isValid()) {
+        device = new PakEntryDevice(m_paks.archive(ref.pak), ref.index, parent);
     }
     else {
-        // ǴԴģʽֱӴļϵͳȡ
-        QDir dir(directory);
-
-        if (recursive) {
-            // ݹȡĿ¼ļ
-            dir.setNameFilters(filters);
-            dir.setFilter(QDir::Files | QDir::NoDotAndDotDot);
-            result = dir.entryInfoList();
-
-            // ȡĿ¼
-            QDirIterator it(directory, QDir::Dirs | QDir::NoDotAndDotDot,
-                QDirIterator::Subdirectories);
-            while (it.hasNext()) {
-                QString subDir = it.next();
-                QDir subQDir(subDir);
-                result.append(subQDir.entryInfoList(filters, QDir::Files));
-            }
-        }
-        else {
-            // ǵݹȡļ
-            result = dir.entryInfoList(filters, QDir::Files);
-        }
+        const QByteArray data = getData(path);
+        if (data.isNull()) return nullptr;
+        QBuffer* buffer = new QBuffer(parent);
+        buffer->setData(data);
+        device = buffer;
     }
 
-    return result;
-}
\ No newline at end of file
+    if (!device->open(QIODevice::ReadOnly)) {
+        qDebug() << "[ResourceManager] cannot open stream:" << path << device->errorString();
+        delete device;
+        return nullptr;
+    }
+    return device;
+}
+
+QStringList ResourceManager::listFiles(const QString& directory,
+    const QStringList& filters,
+    bool recursive) const {
+    // Ŀ¼ڹʱã㼶ңٱȫĿ
+    return m_vfs.list(normalizePath(directory), filters, recursive);
+}
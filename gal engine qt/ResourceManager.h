@@ -6,38 +6,146 @@
 #include <QSet>
 #include <QMap>
 #include <QStringList>
-#include <QFileInfoList>
+#include <QPointer>
+#include <QHash>
+#include <QVector>
+#include <QReadWriteLock>
+#include <QIODevice>
+#include <functional>
+#include "AssetId.h"
+#include "PakStack.h"
+#include "Vfs.h"
+#include "VfsBackends.h"
+#include "PixmapCache.h"
+#include "ImageDecodeQueue.h"
+#include "ThumbnailCache.h"
+#include "IoQueue.h"
+#include "AssetTelemetry.h"
+#include "HotSet.h"
 
 class ResourceManager : public QObject {
     Q_OBJECT
 public:
     static ResourceManager& instance();
 
-    static constexpr bool USE_PACKED_RESOURCES = false;
-    //开关：true=打包模式，false=明文模式
+    static constexpr bool USE_MEMORY_MAPPED_PAK = true;
+    //打包模式下映射资源包，未压缩的条目直接引用映射内存（零拷贝）
+
+    static constexpr bool DECODE_PACKAGE_ON_LOAD = false;
+    //true=加载资源包时多线程解压全部条目，false=首次访问时再解压
+
+    static constexpr bool RECORD_ASSET_TELEMETRY = true;
+    //记录每个资源的读取/解码耗时、字节数、缓存命中和推进剧情时的同步卡顿
+
+    static constexpr bool PREWARM_HOT_SET = true;
+    //退出时把常用资源记入 cache/hotset.json，下次启动在标题画面空闲时预热
+
+    using PixmapCallback = std::function<void(const QPixmap&)>;
+
+    // 资源路径驻留为紧凑的 AssetId，热路径上按下标访问，不再反复哈希字符串。
+    // 同一路径始终得到同一个 id；空路径返回 INVALID_ASSET。线程安全。
+    AssetId assetId(const QString& path) const;
+    QString assetPath(AssetId id) const;
+    // 只查不驻留；未驻留时为 INVALID_ASSET
+    AssetId findAssetId(const QString& path) const;
+    // 打包时裁掉透明边的立绘：原画布尺寸和偏移，未裁剪时 isTrimmed() 为 false
+    SpriteTrim spriteTrim(AssetId id) const;
 
     void preloadImage(const QString& path);
     void preloadImages(const QStringList& paths);
     QPixmap getPixmap(const QString& path) const;
+    QPixmap getPixmap(AssetId id) const;
+    // 按显示尺寸取图：选能等比铺满 targetSize 的最小预缩放版本（packer.py --mips），
+    // 再缩放到 targetSize 以内。没有合适版本时缩放原图并缓存结果。
+    QPixmap getPixmap(const QString& path, const QSize& targetSize) const;
+    QPixmap getPixmap(AssetId id, const QSize& targetSize) const;
     bool hasPixmap(const QString& path) const;
+    bool hasPixmap(AssetId id) const;
+
+    // 异步解码：工作线程解码为 QImage，回到 GUI 线程再转成 QPixmap。
+    // 已缓存时立即回调；解码失败或被取消回调空 QPixmap；context 销毁后不再回调。
+    void getPixmapAsync(AssetId id, ImageDecodeQueue::Priority priority,
+        QObject* context, PixmapCallback callback);
+    // 撤销 context 的等待；无人等待时降为预读优先级，结果仍进入缓存
+    void cancelPixmapAsync(AssetId id, QObject* context);
+    // 取消解码，所有等待者回调空 QPixmap
+    void cancelDecode(AssetId id);
+
+    // 脚本预读：后台解码图片 / 解出音频第一块，不阻塞调用方
+    void prefetchImage(AssetId id, ImageDecodeQueue::Priority priority = ImageDecodeQueue::NextLine);
+    void prefetchAudio(AssetId id);
+    // 撤销无人等待的预读（例如未被选中的分支）
+    void cancelPrefetch(AssetId id);
+
+    // 预热：extra（例如最近存档的场景）在前，随后是热度记录里的资源。
+    // 图片以预读优先级逐张解码进缓存（同时只有一张），音频照 prefetchAudio 预读；不计入命中统计
+    void prewarm(const QStringList& extraImages = QStringList(), const QStringList& extraAudio = QStringList());
+    // 本次的图片命中/未命中和音频打开次数并入热度记录，退出时调用
+    bool saveHotSet() const;
+
+    // 图片缓存：按字节预算做 LRU 淘汰，当前显示的资源需 pin 住
+    void setPixmapCacheBudget(qint64 bytes);
+    void pinPixmap(AssetId id);
+    void unpinPixmap(AssetId id);
+    PixmapCache::Stats pixmapCacheStats() const;
+
+    // 资源访问统计：按 AssetId 查询（assetId() 换算路径），或导出为 CSV / JSON（按扩展名）。
+    // 卡顿 = GUI 线程在 ScriptEngine::advance() 内同步读取或解码的时间
+    const AssetTelemetry& telemetry() const { return m_telemetry; }
+    AssetTelemetry& telemetry() { return m_telemetry; }
+    bool dumpTelemetry(const QString& filename) const;
+    // 访问顺序记录：每行 "首次使用毫秒<Tab>资源路径"，按首次使用排序。
+    // packer.py --order 据此把启动时用到的条目排在包开头并标为热区
+    bool writeAccessTrace(const QString& filename) const;
+
+    // 缩略图磁盘缓存（cache/thumbnails.bin），按路径 + 修改时间/大小失效。
+    // 首次使用时打开；未命中时调用 request()，后台生成后发出 ready()
+    ThumbnailCache& thumbnails();
 
     void registerAudio(const QString& path);
     bool hasAudio(const QString& path) const;
+    // 播放器直接从磁盘打开的音频：登记为音频并计一次打开（包内音频经 openStream 计数），返回其 id
+    AssetId recordAudioOpen(const QString& path);
 
     QJsonDocument loadJsonDocument(const QString& path) const;
     QJsonObject loadJsonObject(const QString& path) const;
     QString loadTextFile(const QString& path) const;
 
+    // 资源来源在运行时挂载到 VFS：明文目录 (mountDirectory) 或资源包 (loadPackage)。
+    // 两者都挂载时资源包优先
+    bool mountDirectory(const QString& dir);
+    bool isPacked() const { return !m_paks.isEmpty(); }
+    Vfs& vfs() { return m_vfs; }
+
+    // 基础包（优先级 0）
     bool loadPackage(const QString& filename);
+    // 补丁 / DLC：按优先级叠加在已挂载的包之上，同名条目高优先级胜出，
+    // 墓碑条目删除下层资源。只读新包的目录表，可在运行中挂载
+    bool mountPackage(const QString& filename, int priority);
+    static constexpr int BASE_PACKAGE_PRIORITY = 0;
+    // 后台并行校验所有已挂载包的 CRC32C，完成后发出 packagesVerified()。
+    // 不调用时条目在首次读取时才校验；损坏的条目读出为空并发出 integrityError()
+    void verifyPackages();
 
     QByteArray getData(const QString& path) const;
+    QByteArray getData(AssetId id) const;
 
-    QFileInfoList getFileList(const QString& directory,
+    bool exists(const QString& path) const;
+    // 磁盘上的文件路径（明文资源、存档），供直接从磁盘流式读取；包内资源返回空
+    QString localFilePath(const QString& path) const;
+    // 只读打开资源供流式读取（音频）：磁盘文件用 QFile，包内条目用 PakEntryDevice
+    // 按块解码、可随机定位，其他来源读入 QBuffer。找不到或打不开时返回 nullptr
+    QIODevice* openStream(const QString& path, QObject* parent = nullptr) const;
+    // 目录下匹配通配符的资源，返回排序后的 VFS 路径（可直接传给 getData / getPixmap）
+    QStringList listFiles(const QString& directory,
         const QStringList& filters = QStringList(),
-        bool recursive = false);
+        bool recursive = false) const;
 
 signals:
     void imageLoaded(const QString& path);
+    void packageProgress(int done, int total); // 由工作线程发出
+    void integrityError(const QString& package, const QString& entry); // 由工作线程发出，每个条目一次
+    void packagesVerified(int corruptEntries); // 由工作线程发出
 
 private:
     explicit ResourceManager(QObject* parent = nullptr);
@@ -47,13 +155,65 @@ private:
     
     
 
-    mutable QMap<QString, QPixmap> m_pixmaps;
+    mutable PixmapCache m_pixmapCache;
+
+    struct PendingPixmap {
+        QPointer<QObject> context;
+        PixmapCallback callback;
+    };
+    ImageDecodeQueue* m_decoder = nullptr;
+    QHash<AssetId, QList<PendingPixmap>> m_pendingPixmaps;
+
+    // 明文模式：预读进 I/O 缓存 (cache) 或只提示系统预读
+    void readAhead(AssetId id, bool cache);
+    IoQueue* m_io = nullptr;
+    static constexpr qint64 IO_CACHE_BUDGET = 64 * 1024 * 1024;
+
+    // 同步路径：读取 + 解码，计入解码耗时
+    QPixmap decodePixmap(AssetId id) const;
+    mutable AssetTelemetry m_telemetry;
+
+    void onImageDecoded(AssetId id, const QImage& image);
+    void deliverPixmap(AssetId id, const QPixmap& px);
     QSet<QString> m_audioPaths;
 
-    QMap<QString, QByteArray> m_resources;
+    struct PrewarmItem {
+        AssetId id;
+        bool audio;
+    };
+    void prewarmNext();
+    QList<PrewarmItem> m_prewarm;
+    bool m_prewarming = false; // 有一张图在解码，完成时取下一项
+    static constexpr const char* HOT_SET_FILE = "cache/hotset.json";
+    static constexpr qint64 PREWARM_PIXMAP_BUDGET = 64 * 1024 * 1024; // 不挤掉正在显示的图片
+    static constexpr int HOT_PREFIX_HOLD_MS = 60 * 1000; // 挂载后热区副本最多留这么久，启动阶段之后不再常驻
+
+    // 驻留表：id 即下标；pak 为合并索引解析出的包和条目号，local 为磁盘上的文件（没有则为空），挂载时重新解析
+    struct AssetSlot {
+        QString path;
+        QString local;
+        PakStack::Ref pak;
+        SpriteTrim trim;
+        QVector<PakArchive::Variant> variants;
+    };
+    void resolveSlot(AssetSlot& slot) const;
+    AssetId pickVariant(AssetId id, const QSize& targetSize) const;
+    ThumbnailCache::Stamp sourceStamp(const QString& path) const;
+    QByteArray thumbnailSource(const QString& path, const QSize& box) const;
+    ThumbnailCache* m_thumbnails = nullptr;
+    mutable QReadWriteLock m_assetLock;
+    mutable QVector<AssetSlot> m_assets;
+    mutable QHash<QString, AssetId> m_assetIds;
+
+    // 资源包：基础包 + 补丁叠加；v2 按需解压，v1 打开时全部解压
+    mutable PakStack m_paks;
+    Vfs m_vfs;
+    std::shared_ptr<PakBackend> m_pakBackend;
+    static constexpr int LOOSE_VFS_PRIORITY = 0;
+    static constexpr int PACKAGE_VFS_PRIORITY = 1;
 
     
     QString normalizePath(const QString& path) const;
-    QByteArray xorDecrypt(const QByteArray& data) const;
-    QByteArray zlibUncompress(const QByteArray& data) const;
+    // getData(path) 去掉统计后的实际读取
+    QByteArray readData(const QString& path) const;
 };
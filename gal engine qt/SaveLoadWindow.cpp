@@ -1,5 +1,6 @@
 #include "SaveLoadWindow.h"
 #include "ScriptEngine.h"
+#include "ResourceManager.h"
 #include <QFile>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -8,6 +9,8 @@
 #include <QMessageBox>
 #include <QPixmap>
 
+const QSize SLOT_ICON_SIZE(200, 100);
+
 SaveLoadWindow::SaveLoadWindow(ScriptEngine* engine, Mode mode, QWidget* parent)
     : QDialog(parent), m_engine(engine), m_mode(mode), m_currentPage(0) {
 
@@ -46,6 +49,9 @@ SaveLoadWindow::SaveLoadWindow(ScriptEngine* engine, Mode mode, QWidget* parent)
 
     setLayout(mainLayout);
 
+    connect(&ResourceManager::instance().thumbnails(), &ThumbnailCache::ready,
+        this, &SaveLoadWindow::onThumbnailReady);
+
     loadSlots();
     refreshUi();
 }
@@ -98,9 +104,12 @@ void SaveLoadWindow::refreshUi() {
             btn->setText(label);
 
             if (!info.screenshot.isEmpty() && QFile::exists(info.screenshot)) {
-                QPixmap px(info.screenshot);
-                btn->setIcon(QIcon(px));
-                btn->setIconSize(QSize(200, 100));
+                // ͼͼ棺ֱãδк̨ɣ onThumbnailReady 
+                ThumbnailCache& thumbs = ResourceManager::instance().thumbnails();
+                const QImage thumb = thumbs.find(info.screenshot, SLOT_ICON_SIZE);
+                btn->setIcon(thumb.isNull() ? QIcon() : QIcon(QPixmap::fromImage(thumb)));
+                btn->setIconSize(SLOT_ICON_SIZE);
+                if (thumb.isNull()) thumbs.request(info.screenshot, SLOT_ICON_SIZE);
             }
         }
         else {
@@ -117,6 +126,16 @@ void SaveLoadWindow::refreshUi() {
         .arg((m_totalSlots + m_slotsPerPage - 1) / m_slotsPerPage));
 }
 
+void SaveLoadWindow::onThumbnailReady(const QString& path, const QSize& box, const QImage& image) {
+    if (box != SLOT_ICON_SIZE || image.isNull()) return;
+    int start = m_currentPage * m_slotsPerPage;
+    for (int i = 0; i < m_slotsPerPage && start + i < m_slots.size(); i++) {
+        if (m_slots[start + i].screenshot == path) {
+            m_slotButtons[i]->setIcon(QIcon(QPixmap::fromImage(image)));
+        }
+    }
+}
+
 void SaveLoadWindow::onSlotClicked(int index) {
     int slotIndex = m_currentPage * m_slotsPerPage + index;
     if (slotIndex >= m_slots.size()) return;
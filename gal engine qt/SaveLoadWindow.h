@@ -34,6 +34,7 @@ private slots:
     void onSlotClicked(int index);
     void onPrevPage();
     void onNextPage();
+    void onThumbnailReady(const QString& path, const QSize& box, const QImage& image);
 
 private:
     void loadSlots();
@@ -3,6 +3,7 @@
 #include <QVector>
 #include <QVariantMap>
 #include <QMap>
+#include "AssetId.h"
 
 struct GE_ChoiceOption {
     QString text;
@@ -16,6 +17,9 @@ struct GE_Line {
     QString spriteSlot;
     QString profilePath;
     QString profileSlot;
+    AssetId spriteId = INVALID_ASSET;
+    AssetId profileId = INVALID_ASSET;
+    AssetId pathId = INVALID_ASSET; // args.path of bg / ch / music / se
 
     QString cmd;
     QVariantMap args;
@@ -29,6 +33,8 @@ struct GE_Scene {
     QString id;
     QString backgroundPath;
     QString musicPath;
+    AssetId backgroundId = INVALID_ASSET;
+    AssetId musicId = INVALID_ASSET;
     QVector<GE_Line> lines;
 };
 
@@ -13,6 +13,60 @@
 
 bool iswaiting = false;
 
+namespace {
+    QStringList toStringList(const QVariant& v) {
+        QStringList out;
+        if (v.metaType().id() == QMetaType::QString) {
+            out << v.toString();
+        }
+        else if (v.canConvert<QVariantList>()) {
+            for (const auto& vv : v.toList()) out << vv.toString();
+        }
+        return out;
+    }
+
+    // һнűõԴid  parse ʱפ
+    void collectAssets(const GE_Line& ln, QVector<AssetId>& images, QVector<AssetId>& audios) {
+        if (ln.spriteId != INVALID_ASSET) images << ln.spriteId;
+        if (ln.profileId != INVALID_ASSET) images << ln.profileId;
+        if (ln.cmd.isEmpty()) return;
+
+        const QString c = ln.cmd.toLower();
+        if (c == "bg" || c == "ch") {
+            if (ln.pathId != INVALID_ASSET) images << ln.pathId;
+        }
+        else if (c == "music" || c == "se") {
+            if (ln.pathId != INVALID_ASSET) audios << ln.pathId;
+        }
+        else if (c == "preload") {
+            auto& rm = ResourceManager::instance();
+            for (const auto& p : toStringList(ln.args.value("images"))) images << rm.assetId(p);
+            for (const auto& p : toStringList(ln.args.value("audios"))) audios << rm.assetId(p);
+        }
+    }
+
+    // һпתĳѡ֧ settleBranch β
+    QStringList branchTargets(const GE_Line& ln) {
+        QStringList out;
+        if (ln.isChoice) {
+            for (const auto& o : ln.options) out << o.gotoSceneId;
+            return out;
+        }
+        if (ln.cmd.toLower() == "ifflag") {
+            out << ln.args.value("true_scene").toString() << ln.args.value("false_scene").toString();
+        }
+        return out;
+    }
+
+    // תĿ곡һߵ֧
+    QString jumpTarget(const GE_Line& ln) {
+        const QString c = ln.cmd.toLower();
+        return (c == "goto" || c == "jump") ? ln.args.value("scene").toString() : QString();
+    }
+
+    constexpr int BRANCH_HEAD_LINES = 4;
+}
+
 ScriptEngine::ScriptEngine(QObject* parent) : QObject(parent) {}
 
 bool ScriptEngine::loadFromJsonFile(const QString& path) {
@@ -33,9 +87,11 @@ bool ScriptEngine::parse(const QJsonObject& root) {
     m_script = GE_Script();
     m_flags.clear();
     m_history.clear();
+    m_branchImages.clear();
     m_lineIndex = 0;
     m_currentSceneId.clear();
 
+    auto& rm = ResourceManager::instance();
     m_script.startSceneId = root.value("start").toString();
     const auto arr = root.value("scenes").toArray();
     for (const auto& v : arr) {
@@ -44,6 +100,8 @@ bool ScriptEngine::parse(const QJsonObject& root) {
         s.id = o.value("id").toString();
         s.backgroundPath = o.value("background").toString();
         s.musicPath = o.value("music").toString();
+        s.backgroundId = rm.assetId(s.backgroundPath);
+        s.musicId = rm.assetId(s.musicPath);
         const auto lines = o.value("lines").toArray();
         for (const auto& lv : lines) {
             const auto lo = lv.toObject();
@@ -63,6 +121,7 @@ bool ScriptEngine::parse(const QJsonObject& root) {
                 ln.cmd = lo.value("cmd").toString();
                 const auto args = lo.value("args").toObject();
                 for (auto it = args.begin(); it != args.end(); ++it) ln.args[it.key()] = it.value().toVariant();
+                ln.pathId = rm.assetId(ln.args.value("path").toString());
             }
             else {
                 ln.speaker = lo.value("speaker").toString();
@@ -71,6 +130,8 @@ bool ScriptEngine::parse(const QJsonObject& root) {
                 ln.spriteSlot = lo.value("slot").toString();
                 ln.profilePath = lo.value("psprite").toString();
                 ln.profileSlot = lo.value("pslot").toString();
+                ln.spriteId = rm.assetId(ln.spritePath);
+                ln.profileId = rm.assetId(ln.profilePath);
             }
             s.lines.push_back(std::move(ln));
         }
@@ -92,16 +153,19 @@ void ScriptEngine::start(const QString& sceneId) {
         
     if (!sc.backgroundPath.isEmpty()) {
         m_currentBackground = sc.backgroundPath;
-        emit backgroundChanged(sc.backgroundPath);
+        emit backgroundChanged(sc.backgroundId);
     }
     advance();
 }
 
 void ScriptEngine::advance() {
+    // ƽڼ GUI ߳ϵͬԴȡΪ٣ AssetTelemetry
+    AssetTelemetry::AdvanceScope telemetryScope;
     if (!m_script.scenes.contains(m_currentSceneId)) { emit scriptEnded(); return; }
     auto& sc = m_script.scenes[m_currentSceneId];
     if (m_lineIndex >= sc.lines.size()) { emit scriptEnded(); return; }
     const GE_Line& ln = sc.lines[m_lineIndex++];
+    prefetchAhead();
     if (ln.isChoice) {
         QStringList opts; for (const auto& o : ln.options) opts << o.text;
         emit textReady("", "");
@@ -115,12 +179,12 @@ void ScriptEngine::advance() {
     if (!ln.spritePath.isEmpty()) {
         QString slot = ln.spriteSlot.isEmpty() ? "center" : ln.spriteSlot;
         m_currentSprites[slot] = ln.spritePath;
-        emit spriteChanged(ln.spriteSlot.isEmpty() ? "center" : ln.spriteSlot, ln.spritePath);
+        emit spriteChanged(ln.spriteSlot.isEmpty() ? "center" : ln.spriteSlot, ln.spriteId);
     }
     if (!ln.profilePath.isEmpty()) {
         QString sslot = ln.profileSlot.isEmpty() ? "pleft" : ln.profileSlot;
         m_currentProfiles[sslot] = ln.profilePath;
-        emit spriteChangedTop(ln.spriteSlot.isEmpty() ? "pleft" : ln.profileSlot, ln.profilePath);
+        emit spriteChangedTop(ln.spriteSlot.isEmpty() ? "pleft" : ln.profileSlot, ln.profileId);
     }
     emit textReady(ln.speaker, ln.text);
 }
@@ -131,6 +195,7 @@ void ScriptEngine::onChoiceSelected(int index) {
     const GE_Line& ln = sc.lines[m_lineIndex - 1];
     if (!ln.isChoice || index < 0 || index >= ln.options.size()) { advance(); return; }
     const auto target = ln.options[index].gotoSceneId;
+    settleBranch(target);
     if (!target.isEmpty() && m_script.scenes.contains(target)) {
         m_history.push(qMakePair(m_currentSceneId, m_lineIndex));
         m_currentSceneId = target;
@@ -143,7 +208,7 @@ void ScriptEngine::onChoiceSelected(int index) {
         }
         if (!nsc.backgroundPath.isEmpty()) {
             m_currentBackground = nsc.backgroundPath;
-            emit backgroundChanged(nsc.backgroundPath);
+            emit backgroundChanged(nsc.backgroundId);
         }
     }
     advance();
@@ -155,7 +220,7 @@ void ScriptEngine::handleCommand(const GE_Line& ln) {
         const QString p = ln.args.value("path").toString();
         if (!p.isEmpty()) {
             m_currentBackground = p;
-            emit backgroundChanged(p);
+            emit backgroundChanged(ln.pathId);
         } 
         advance();
     }
@@ -188,7 +253,7 @@ void ScriptEngine::handleCommand(const GE_Line& ln) {
         const QString path = ln.args.value("path").toString();
         const QString slot = ln.args.value("slot").toString();
         m_currentSprites[slot] = path;
-        emit spriteChanged(slot.isEmpty() ? "center" : slot, path);
+        emit spriteChanged(slot.isEmpty() ? "center" : slot, ln.pathId);
     }
     else if (c == "clear") {
         const QString slot = ln.args.value("slot").toString();
@@ -237,7 +302,7 @@ void ScriptEngine::handleCommand(const GE_Line& ln) {
             }
             if (!nsc.backgroundPath.isEmpty()) {
                 m_currentBackground = nsc.backgroundPath;
-                emit backgroundChanged(nsc.backgroundPath);
+                emit backgroundChanged(nsc.backgroundId);
             }
             //if (!saveName.isEmpty()) emit autosavePoint(saveName);
         }
@@ -254,6 +319,7 @@ void ScriptEngine::handleCommand(const GE_Line& ln) {
         const QVariant want = ln.args.value("value");
         const QString ts = ln.args.value("true_scene").toString();
         const QString fs = ln.args.value("false_scene").toString();
+        settleBranch(m_flags.value(key) == want ? ts : fs);
         if (m_flags.value(key) == want) {
             if (!ts.isEmpty() && m_script.scenes.contains(ts)) {
                 m_history.push(qMakePair(m_currentSceneId, m_lineIndex));
@@ -266,7 +332,7 @@ void ScriptEngine::handleCommand(const GE_Line& ln) {
                 }
                 if (!nsc.backgroundPath.isEmpty()) {
                     m_currentBackground = nsc.backgroundPath;
-                    emit backgroundChanged(nsc.backgroundPath);
+                    emit backgroundChanged(nsc.backgroundId);
                 }
             }
         }
@@ -282,34 +348,15 @@ void ScriptEngine::handleCommand(const GE_Line& ln) {
                 }
                 if (!nsc.backgroundPath.isEmpty()) {
                     m_currentBackground = nsc.backgroundPath;
-                    emit backgroundChanged(nsc.backgroundPath);
+                    emit backgroundChanged(nsc.backgroundId);
                 }
             }
         }
         advance();
     }
     else if (c == "preload") {
-        QStringList images;
-        QStringList audios;
-        if (ln.args.contains("images")) {
-            QVariant v = ln.args.value("images");
-            if (v.canConvert<QVariantList>()) {
-                for (auto vv : v.toList()) images << vv.toString();
-            }
-            else if (v.metaType().id() == QMetaType::QString)
-            {
-                images << v.toString();
-            }
-        }
-        if (ln.args.contains("audios")) {
-            QVariant v = ln.args.value("audios");
-            if (v.canConvert<QVariantList>()) {
-                for (auto vv : v.toList()) audios << vv.toString();
-            }
-            else if (v.metaType().id() == QMetaType::QString) {
-                audios << v.toString();
-            }
-        }
+        const QStringList images = toStringList(ln.args.value("images"));
+        const QStringList audios = toStringList(ln.args.value("audios"));
         if (!images.isEmpty() || !audios.isEmpty()) emit preloadRequested(images, audios);
         advance();
     }
@@ -329,6 +376,74 @@ void ScriptEngine::handleCommand(const GE_Line& ln) {
     }
 }
 
+void ScriptEngine::prefetchAhead() {
+    if (m_lookahead <= 0) return;
+    auto it = m_script.scenes.constFind(m_currentSceneId);
+    if (it == m_script.scenes.constEnd()) return;
+
+    auto& rm = ResourceManager::instance();
+    const auto& lines = it->lines;
+    const int end = qMin<int>(lines.size(), m_lineIndex + m_lookahead);
+    for (int i = m_lineIndex; i < end; ++i) {
+        // ŵȣఴԤŶӵֻᱻȼ
+        const auto priority = (i - m_lineIndex < 2) ? ImageDecodeQueue::NextLine : ImageDecodeQueue::Speculative;
+        QVector<AssetId> images, audios;
+        collectAssets(lines[i], images, audios);
+        for (AssetId id : images) rm.prefetchImage(id, priority);
+        for (AssetId id : audios) rm.prefetchAudio(id);
+
+        const QStringList targets = branchTargets(lines[i]);
+        if (!targets.isEmpty()) prefetchBranches(targets);
+
+        const QString jump = jumpTarget(lines[i]);
+        if (!jump.isEmpty()) {
+            images.clear();
+            audios.clear();
+            collectSceneHead(jump, images, audios);
+            for (AssetId id : images) rm.prefetchImage(id, ImageDecodeQueue::NextLine);
+            for (AssetId id : audios) rm.prefetchAudio(id);
+        }
+    }
+}
+
+void ScriptEngine::collectSceneHead(const QString& sceneId, QVector<AssetId>& images, QVector<AssetId>& audios) const {
+    auto it = m_script.scenes.constFind(sceneId);
+    if (it == m_script.scenes.constEnd()) return;
+
+    if (it->backgroundId != INVALID_ASSET) images << it->backgroundId;
+    if (it->musicId != INVALID_ASSET) audios << it->musicId;
+    const int end = qMin<int>(it->lines.size(), BRANCH_HEAD_LINES);
+    for (int i = 0; i < end; ++i) collectAssets(it->lines[i], images, audios);
+}
+
+void ScriptEngine::prefetchBranches(const QStringList& sceneIds) {
+    auto& rm = ResourceManager::instance();
+    for (const auto& sceneId : sceneIds) {
+        QVector<AssetId> images, audios;
+        collectSceneHead(sceneId, images, audios);
+        for (AssetId id : images) {
+            rm.prefetchImage(id, ImageDecodeQueue::Speculative);
+            m_branchImages.insert(id);
+        }
+        for (AssetId id : audios) rm.prefetchAudio(id);
+    }
+}
+
+void ScriptEngine::settleBranch(const QString& chosenSceneId) {
+    // ѡеķ֧Ϊһȼѡ֧Ԥ
+    QVector<AssetId> images, audios;
+    collectSceneHead(chosenSceneId, images, audios);
+
+    auto& rm = ResourceManager::instance();
+    for (AssetId id : images) rm.prefetchImage(id, ImageDecodeQueue::NextLine);
+
+    const QSet<AssetId> keep(images.cbegin(), images.cend());
+    for (AssetId id : std::as_const(m_branchImages)) {
+        if (!keep.contains(id)) rm.cancelPrefetch(id);
+    }
+    m_branchImages.clear();
+}
+
 QVariantMap ScriptEngine::snapshot() const {
     QVariantMap m;
     m["scene"] = m_currentSceneId;
@@ -371,7 +486,7 @@ void ScriptEngine::restore(const QVariantMap& m) {
 
     if (!bg.isEmpty() && bg != m_currentBackground) {
         m_currentBackground = bg;
-        emit backgroundChanged(bg);
+        emit backgroundChanged(ResourceManager::instance().assetId(bg));
     }
 
     for (auto it = spritesVm.constBegin(); it != spritesVm.constEnd(); ++it) {
@@ -379,7 +494,7 @@ void ScriptEngine::restore(const QVariantMap& m) {
         const QString path = it.value().toString();
         if (m_currentSprites.value(slot) != path) {
             m_currentSprites[slot] = path;
-            emit spriteChanged(slot, path);
+            emit spriteChanged(slot, ResourceManager::instance().assetId(path));
         }
     }
 
@@ -402,7 +517,7 @@ void ScriptEngine::restore(const QVariantMap& m) {
         const QString path = it.value().toString();
         if (m_currentProfiles.value(slot) != path) {
             m_currentProfiles[slot] = path;
-            emit spriteChangedTop(slot, path);
+            emit spriteChangedTop(slot, ResourceManager::instance().assetId(path));
         }
     }
     {
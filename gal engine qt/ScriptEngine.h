@@ -4,6 +4,7 @@
 #include <QStack>
 #include <QPair>
 #include <QVariant>
+#include <QSet>
 #include "SceneTypes.h"
 
 class StartWindow;
@@ -20,13 +21,18 @@ public:
 
     void start(const QString& sceneId = QString());
 
+    // ÿƽʱԤ N õͼƬƵ0 = ر
+    void setLookahead(int lines) { m_lookahead = qMax(0, lines); }
+    int lookahead() const { return m_lookahead; }
+
     QVariantMap snapshot() const;
     void restore(const QVariantMap& m);
 
 signals:
-    void backgroundChanged(const QString& path);
-    void spriteChanged(const QString& slot, const QString& path);
-    void spriteChangedTop(const QString& slot, const QString& path);
+    // ͼƬפõ AssetId շٰ·
+    void backgroundChanged(AssetId id);
+    void spriteChanged(const QString& slot, AssetId id);
+    void spriteChangedTop(const QString& slot, AssetId id);
     void spriteCleared(const QString& slot);
     void spriteClearedTop(const QString& slot);
     void textReady(const QString& speaker, const QString& text);
@@ -59,6 +65,14 @@ private:
     QMap<QString, QString> m_currentProfiles;
 
     void handleCommand(const GE_Line& ln);
+    void prefetchAhead();
+    int m_lookahead = 8;
+
+    // ֧Ԥѡ / ifflag / goto ĺѡͷԴ
+    void collectSceneHead(const QString& sceneId, QVector<AssetId>& images, QVector<AssetId>& audios) const;
+    void prefetchBranches(const QStringList& sceneIds);
+    void settleBranch(const QString& chosenSceneId);
+    QSet<AssetId> m_branchImages;
     GE_Script m_script;
     QString m_currentSceneId;
     int m_lineIndex = 0;
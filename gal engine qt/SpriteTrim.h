@@ -0,0 +1,12 @@
+#pragma once
+#include <QSize>
+#include <QPoint>
+
+// Where a sprite trimmed by the packer sits on its original canvas.
+// An invalid canvas means the image was not trimmed.
+struct SpriteTrim {
+    QSize canvas;
+    QPoint offset;
+
+    bool isTrimmed() const { return canvas.isValid(); }
+};
@@ -17,6 +17,10 @@
 #include <QMediaPlayer>
 #include <QAudioOutput>
 #include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QTimer>
+#include <algorithm>
 
 
 const QString BACKGROUND_IMAGE_PATH = "resources/background.png";
@@ -35,6 +39,8 @@ const QString GALLERY_SOUND_PATH = "resources/gallery.mp3";
 const QString SETTING_SOUND_PATH = "resources/setting.mp3";
 const QString EXIT_SOUND_PATH = "resources/exit.mp3";
 
+const int PREWARM_DELAY_MS = 500; // ⻭ʾжÿʼԤ
+
 StartWindow::StartWindow(QWidget* parent) : QWidget(parent)
 {
     loadHidden();
@@ -323,4 +329,37 @@ void StartWindow::showEvent(QShowEvent* event)
     if (ResourceManager::instance().hasAudio(BGM_PATH)) {
         m_audioManager->playBgm(BGM_PATH);
     }
+
+    // ״ʾ󣬳һû㰴ťѳԴ浵ĳ
+    if (!m_prewarmed) {
+        m_prewarmed = true;
+        QTimer::singleShot(PREWARM_DELAY_MS, this, &StartWindow::prewarmLastSession);
+    }
+}
+
+void StartWindow::prewarmLastSession()
+{
+    // һδ浵Զ浵ĳ㡰Ҫľ
+    QFileInfoList saves = QDir("saves").entryInfoList({ "save_slot_*.json" }, QDir::Files);
+    const QFileInfo autosave(QDir::current().filePath("autosave_last.json"));
+    if (autosave.exists()) saves.append(autosave);
+
+    QStringList images;
+    QStringList audio;
+    if (!saves.isEmpty()) {
+        const QFileInfo latest = *std::max_element(saves.begin(), saves.end(),
+            [](const QFileInfo& a, const QFileInfo& b) { return a.lastModified() < b.lastModified(); });
+        QFile f(latest.filePath());
+        if (f.open(QIODevice::ReadOnly)) {
+            const QVariantMap m = QJsonDocument::fromJson(f.readAll()).toVariant().toMap();
+            images << m.value("background").toString();
+            for (const QVariant& v : m.value("sprites").toMap()) images << v.toString();
+            for (const QVariant& v : m.value("profiles").toMap()) images << v.toString();
+            audio << m.value("bgm").toString();
+        }
+    }
+    images.removeAll(QString());
+    audio.removeAll(QString());
+
+    ResourceManager::instance().prewarm(images, audio);
 }
\ No newline at end of file
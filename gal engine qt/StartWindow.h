@@ -45,6 +45,9 @@ private:
     AudioManager* m_audioManager = nullptr;
 
     void loadHidden();
+
+    bool m_prewarmed = false;
+    void prewarmLastSession();
 };
 
 #endif // STARTWINDOW_H
\ No newline at end of file
@@ -0,0 +1,284 @@
+#include "ThumbnailCache.h"
+#include "ImageDecodeQueue.h"
+#include <QBuffer>
+#include <QDir>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QThread>
+#include <QDebug>
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+    constexpr qint64 HEADER_SIZE = 16;
+    constexpr qint64 RECORD_FIXED_SIZE = 40;
+    constexpr qint64 COMPACT_MIN_DEAD = 4 * 1024 * 1024;
+
+    qint64 align16(qint64 n) { return (n + 15) & ~qint64(15); }
+
+    template <typename T>
+    T readLE(const uchar* p) {
+        return qFromLittleEndian<T>(p);
+    }
+}
+
+ThumbnailCache::ThumbnailCache(const QString& fileName, Loader loader, Stamper stamper, QObject* parent)
+    : QObject(parent), m_fileName(fileName), m_loader(std::move(loader)), m_stamper(std::move(stamper)) {
+    // leave a core for the GUI thread and the image decode queue
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+    open();
+}
+
+ThumbnailCache::~ThumbnailCache() {
+    m_pool.clear();
+    m_pool.waitForDone();
+    closeFile();
+}
+
+QString ThumbnailCache::keyOf(const QString& path, const QSize& box) {
+    return QString("%1@%2x%3").arg(path).arg(box.width()).arg(box.height());
+}
+
+void ThumbnailCache::open() {
+    QDir().mkpath(QFileInfo(m_fileName).path());
+    if (!openFile()) return;
+
+    const qint64 live = scan();
+    const qint64 dead = m_mapSize - HEADER_SIZE - live;
+    if (dead > qMax(live, COMPACT_MIN_DEAD) && m_map) {
+        const QString tmpName = m_fileName + ".tmp";
+        const bool written = writeLive(tmpName);
+        closeFile();
+        if (!written || !QFile::remove(m_fileName) || !QFile::rename(tmpName, m_fileName)) {
+            qDebug() << "[ThumbnailCache] compaction failed";
+            QFile::remove(tmpName);
+        }
+        if (openFile()) scan();
+    }
+}
+
+// Opens (or resets) the file and maps everything already in it.
+bool ThumbnailCache::openFile() {
+    m_file.setFileName(m_fileName);
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        qDebug() << "[ThumbnailCache] cannot open" << m_fileName << m_file.errorString();
+        return false;
+    }
+
+    uchar header[HEADER_SIZE] = {};
+    const bool valid = m_file.read(reinterpret_cast<char*>(header), HEADER_SIZE) == HEADER_SIZE
+        && readLE<quint32>(header) == MAGIC && readLE<quint16>(header + 4) == VERSION;
+    if (!valid) resetFile();
+
+    m_mapSize = m_file.size();
+    if (m_mapSize > HEADER_SIZE) {
+        m_map = m_file.map(0, m_mapSize);
+        if (!m_map) {
+            qDebug() << "[ThumbnailCache] mmap failed, starting empty:" << m_file.errorString();
+            resetFile();
+        }
+    }
+    return true;
+}
+
+void ThumbnailCache::resetFile() {
+    uchar header[HEADER_SIZE] = {};
+    qToLittleEndian<quint32>(MAGIC, header);
+    qToLittleEndian<quint16>(VERSION, header + 4);
+    m_file.resize(0);
+    m_file.seek(0);
+    m_file.write(reinterpret_cast<const char*>(header), HEADER_SIZE);
+    m_file.flush();
+    m_mapSize = HEADER_SIZE;
+}
+
+void ThumbnailCache::closeFile() {
+    if (m_map) m_file.unmap(const_cast<uchar*>(m_map));
+    m_map = nullptr;
+    m_mapSize = 0;
+    m_appendPos = 0;
+    m_file.close();
+    m_records.clear();
+}
+
+// Builds m_records from the mapping and returns the bytes of live records.
+// A truncated tail (crash mid-append) ends the scan; appends overwrite it.
+qint64 ThumbnailCache::scan() {
+    m_records.clear();
+    qint64 pos = HEADER_SIZE;
+    while (m_map && pos + RECORD_FIXED_SIZE <= m_mapSize) {
+        const uchar* r = m_map + pos;
+        const quint32 recordSize = readLE<quint32>(r);
+        const quint16 pathLen = readLE<quint16>(r + 4);
+        const quint16 width = readLE<quint16>(r + 28);
+        const quint16 height = readLE<quint16>(r + 30);
+        const quint32 bytesPerLine = readLE<quint32>(r + 32);
+        const qint64 pixels = align16(RECORD_FIXED_SIZE + pathLen);
+
+        if (width == 0 || height == 0 || bytesPerLine < quint32(width) * 4) break;
+        if (recordSize < pixels + qint64(bytesPerLine) * height || pos + recordSize > m_mapSize) break;
+
+        Record rec;
+        rec.stamp.mtime = readLE<qint64>(r + 8);
+        rec.stamp.size = readLE<qint64>(r + 16);
+        rec.recordOffset = pos;
+        rec.recordSize = recordSize;
+        rec.offset = pos + pixels;
+        rec.size = QSize(width, height);
+        rec.bytesPerLine = int(bytesPerLine);
+        rec.format = QImage::Format(readLE<quint16>(r + 6));
+
+        const QSize box(readLE<quint16>(r + 24), readLE<quint16>(r + 26));
+        const QString path = QString::fromUtf8(reinterpret_cast<const char*>(r + RECORD_FIXED_SIZE), pathLen);
+        m_records.insert(keyOf(path, box), rec);
+        pos += recordSize;
+    }
+    m_appendPos = pos;
+
+    qint64 live = 0;
+    for (const Record& rec : std::as_const(m_records)) live += rec.recordSize;
+    return live;
+}
+
+bool ThumbnailCache::writeLive(const QString& fileName) const {
+    QFile out(fileName);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+
+    bool ok = out.write(reinterpret_cast<const char*>(m_map), HEADER_SIZE) == HEADER_SIZE;
+    for (const Record& rec : m_records) {
+        if (!ok) break;
+        ok = out.write(reinterpret_cast<const char*>(m_map + rec.recordOffset), rec.recordSize) == rec.recordSize;
+    }
+    return ok;
+}
+
+QImage ThumbnailCache::find(const QString& path, const QSize& box) {
+    Record rec;
+    bool check = false;
+    {
+        QMutexLocker lock(&m_mutex);
+        const QString key = keyOf(path, box);
+        auto it = m_records.constFind(key);
+        if (it == m_records.constEnd()) return QImage();
+        rec = it.value();
+        if (!rec.checked && !m_queued.contains(key)) {
+            m_queued.insert(key);
+            check = true;
+        }
+    }
+
+    // the stamp may cost a stat: check it on a worker, show what we have meanwhile
+    if (check) m_pool.start([this, path, box]() { revalidate(path, box); });
+    if (!rec.image.isNull()) return rec.image;
+    if (!m_map) return QImage();
+    // read-only view over the mapping; QPixmap::fromImage makes its own copy
+    return QImage(m_map + rec.offset, rec.size.width(), rec.size.height(), rec.bytesPerLine, rec.format);
+}
+
+void ThumbnailCache::request(const QString& path, const QSize& box) {
+    {
+        QMutexLocker lock(&m_mutex);
+        const QString key = keyOf(path, box);
+        if (m_queued.contains(key)) return;
+        m_queued.insert(key);
+    }
+    m_pool.start([this, path, box]() { generate(path, box, m_stamper(path)); });
+}
+
+void ThumbnailCache::cancelAll() {
+    m_pool.clear();
+    QMutexLocker lock(&m_mutex);
+    m_queued.clear();
+}
+
+void ThumbnailCache::revalidate(const QString& path, const QSize& box) {
+    const Stamp stamp = m_stamper(path);
+    {
+        QMutexLocker lock(&m_mutex);
+        const QString key = keyOf(path, box);
+        auto it = m_records.find(key);
+        if (it != m_records.end() && it->stamp == stamp) {
+            it->checked = true;
+            m_queued.remove(key);
+            return;
+        }
+    }
+    generate(path, box, stamp);
+}
+
+void ThumbnailCache::generate(const QString& path, const QSize& box, const Stamp& stamp) {
+    QImage image;
+    if (stamp.isValid()) {
+        QByteArray data = m_loader(path, box);
+        QBuffer buffer(&data);
+        QImageReader reader(&buffer);
+        const QSize full = reader.size();
+        if (full.isValid()) {
+            // decoders that support it (JPEG) skip the full-size pass entirely
+            if (full.width() > box.width() || full.height() > box.height()) {
+                reader.setScaledSize(full.scaled(box, Qt::KeepAspectRatio));
+            }
+            image = reader.read();
+        }
+        else {
+            // QOI and raw blobs have no Qt image plugin
+            image = ImageDecodeQueue::decode(data);
+            if (image.width() > box.width() || image.height() > box.height()) {
+                image = image.scaled(box, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+            }
+        }
+    }
+
+    if (!image.isNull()) {
+        image = image.convertToFormat(image.hasAlphaChannel()
+            ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32);
+        append(path, box, stamp, image);
+    }
+
+    {
+        QMutexLocker lock(&m_mutex);
+        const QString key = keyOf(path, box);
+        if (image.isNull()) m_records.remove(key); // source gone or unreadable: drop the stale record
+        m_queued.remove(key);
+    }
+    emit ready(path, box, image);
+}
+
+void ThumbnailCache::append(const QString& path, const QSize& box, const Stamp& stamp, const QImage& image) {
+    const QByteArray pathBytes = path.toUtf8();
+    const qint64 bytesPerLine = qint64(image.width()) * 4;
+    const qint64 pixels = align16(RECORD_FIXED_SIZE + pathBytes.size());
+    const qint64 recordSize = align16(pixels + bytesPerLine * image.height());
+
+    QByteArray record(recordSize, '\0');
+    uchar* r = reinterpret_cast<uchar*>(record.data());
+    qToLittleEndian<quint32>(quint32(recordSize), r);
+    qToLittleEndian<quint16>(quint16(pathBytes.size()), r + 4);
+    qToLittleEndian<quint16>(quint16(image.format()), r + 6);
+    qToLittleEndian<qint64>(stamp.mtime, r + 8);
+    qToLittleEndian<qint64>(stamp.size, r + 16);
+    qToLittleEndian<quint16>(quint16(box.width()), r + 24);
+    qToLittleEndian<quint16>(quint16(box.height()), r + 26);
+    qToLittleEndian<quint16>(quint16(image.width()), r + 28);
+    qToLittleEndian<quint16>(quint16(image.height()), r + 30);
+    qToLittleEndian<quint32>(quint32(bytesPerLine), r + 32);
+    std::memcpy(r + RECORD_FIXED_SIZE, pathBytes.constData(), pathBytes.size());
+    for (int y = 0; y < image.height(); ++y) {
+        std::memcpy(r + pixels + y * bytesPerLine, image.constScanLine(y), bytesPerLine);
+    }
+
+    Record rec;
+    rec.stamp = stamp;
+    rec.size = image.size();
+    rec.bytesPerLine = int(bytesPerLine);
+    rec.format = image.format();
+    rec.image = image;
+    rec.checked = true;
+
+    QMutexLocker lock(&m_mutex);
+    if (m_file.isOpen() && m_file.seek(m_appendPos) && m_file.write(record) == record.size()) {
+        m_file.flush();
+        m_appendPos += record.size();
+    }
+    m_records.insert(keyOf(path, box), rec);
+}
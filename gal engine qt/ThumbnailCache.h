@@ -0,0 +1,99 @@
+#pragma once
+#include <QObject>
+#include <QImage>
+#include <QFile>
+#include <QHash>
+#include <QSet>
+#include <QSize>
+#include <QMutex>
+#include <QThreadPool>
+#include <functional>
+
+// Persistent thumbnail store: one append-only file, memory-mapped on open.
+// Records are keyed by source path + box size and carry the source stamp
+// (mtime and size) they were made from. Stamps are checked on a worker the
+// first time a record is found; a record whose stamp no longer matches is
+// regenerated and the new image announced. Newer records shadow older ones,
+// and the file is compacted on open once dead records outweigh live ones.
+// Layout (little-endian):
+//   header: magic u32 "GETH", version u16, reserved u16, reserved u64
+//   record: recordSize u32, pathLen u16, format u16 (QImage::Format),
+//           mtime i64, size i64, boxW u16, boxH u16, width u16, height u16,
+//           bytesPerLine u32, reserved u32, path (UTF-8), pixel rows.
+//   The path is padded so pixel rows start 16-byte aligned; recordSize keeps
+//   the next record aligned too.
+// find() runs on the GUI thread and never touches the source; misses and
+// stale records are generated on worker threads and announced through
+// ready(), emitted from the worker (queued to GUI receivers).
+class ThumbnailCache : public QObject {
+    Q_OBJECT
+public:
+    static constexpr quint32 MAGIC = 0x48544547; // "GETH"
+    static constexpr quint16 VERSION = 1;
+
+    struct Stamp {
+        qint64 mtime = 0;
+        qint64 size = -1;
+        bool isValid() const { return size >= 0; }
+        bool operator==(const Stamp& o) const { return mtime == o.mtime && size == o.size; }
+        bool operator!=(const Stamp& o) const { return !(*this == o); }
+    };
+
+    // Source bytes to thumbnail; the box lets the owner hand back a smaller variant.
+    using Loader = std::function<QByteArray(const QString& path, const QSize& box)>;
+    using Stamper = std::function<Stamp(const QString& path)>;
+
+    ThumbnailCache(const QString& fileName, Loader loader, Stamper stamper, QObject* parent = nullptr);
+    ~ThumbnailCache();
+
+    // Cached thumbnail fitting `box`, or a null image if missing. May be
+    // stale until its stamp has been checked; if it was, ready() follows
+    // with the regenerated image (null if the source is gone).
+    QImage find(const QString& path, const QSize& box);
+    // Generate in the background unless already queued; ready() follows.
+    void request(const QString& path, const QSize& box);
+    // Drop queued requests (e.g. the gallery switched folders).
+    void cancelAll();
+
+signals:
+    void ready(const QString& path, const QSize& box, const QImage& image);
+
+private:
+    struct Record {
+        Stamp stamp;
+        qint64 recordOffset = -1;
+        qint64 recordSize = 0;
+        qint64 offset = -1; // pixel rows inside the mapping; -1 for fresh entries
+        QSize size;
+        int bytesPerLine = 0;
+        QImage::Format format = QImage::Format_Invalid;
+        QImage image;       // fresh entries written after the file was mapped
+        bool checked = false; // stamp compared with the source this session
+    };
+
+    static QString keyOf(const QString& path, const QSize& box);
+
+    void open();
+    bool openFile();
+    void resetFile();
+    void closeFile();
+    qint64 scan();
+    bool writeLive(const QString& fileName) const;
+    void revalidate(const QString& path, const QSize& box);
+    void generate(const QString& path, const QSize& box, const Stamp& stamp);
+    void append(const QString& path, const QSize& box, const Stamp& stamp, const QImage& image);
+
+    QString m_fileName;
+    Loader m_loader;
+    Stamper m_stamper;
+
+    QFile m_file;
+    const uchar* m_map = nullptr;
+    qint64 m_mapSize = 0;
+    qint64 m_appendPos = 0; // end of the last valid record
+
+    QMutex m_mutex; // guards m_records, m_queued and appends to m_file
+    QHash<QString, Record> m_records;
+    QSet<QString> m_queued;
+    QThreadPool m_pool;
+};
@@ -0,0 +1,116 @@
+#include "Trace.h"
+#include <QMutex>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+
+Q_LOGGING_CATEGORY(lcResource, "ge.resource")
+Q_LOGGING_CATEGORY(lcScript, "ge.script")
+Q_LOGGING_CATEGORY(lcUi, "ge.ui")
+
+namespace {
+    struct Event {
+        qint64 nsecs = 0;
+        QtMsgType type = QtDebugMsg;
+        const char* category = nullptr; // categories are static, the pointer stays valid
+        QString message;
+    };
+
+    struct Ring {
+        QMutex mutex;
+        QVector<Event> events;
+        int next = 0;
+        int count = 0;
+        bool passThrough = false;
+        QElapsedTimer clock;
+        QtMessageHandler previous = nullptr;
+    };
+
+    Ring& ring() {
+        static Ring r;
+        return r;
+    }
+
+    const char* typeName(QtMsgType type) {
+        switch (type) {
+        case QtDebugMsg: return "debug";
+        case QtInfoMsg: return "info";
+        case QtWarningMsg: return "warning";
+        case QtCriticalMsg: return "critical";
+        case QtFatalMsg: return "fatal";
+        }
+        return "?";
+    }
+
+    void ringHandler(QtMsgType type, const QMessageLogContext& context, const QString& msg) {
+        Ring& r = ring();
+        QtMessageHandler forward = nullptr;
+        {
+            QMutexLocker lock(&r.mutex);
+            if (!r.events.isEmpty()) {
+                Event& e = r.events[r.next];
+                e.nsecs = r.clock.nsecsElapsed();
+                e.type = type;
+                e.category = context.category;
+                e.message = msg;
+                r.next = (r.next + 1) % r.events.size();
+                r.count = qMin(r.count + 1, int(r.events.size()));
+            }
+            if (r.passThrough || type >= QtWarningMsg) forward = r.previous;
+        }
+
+        if (type == QtFatalMsg) Trace::dumpRingBuffer("trace_fatal.log");
+        if (forward) forward(type, context, msg);
+    }
+}
+
+namespace Trace {
+    void installRingBuffer(int capacity, bool passThrough) {
+        Ring& r = ring();
+        {
+            QMutexLocker lock(&r.mutex);
+            r.events = QVector<Event>(qMax(1, capacity));
+            r.next = 0;
+            r.count = 0;
+            r.passThrough = passThrough;
+            r.clock.start();
+        }
+        QtMessageHandler previous = qInstallMessageHandler(ringHandler);
+        if (previous != ringHandler) {
+            QMutexLocker lock(&r.mutex);
+            r.previous = previous;
+        }
+    }
+
+    void removeRingBuffer() {
+        Ring& r = ring();
+        QMutexLocker lock(&r.mutex);
+        qInstallMessageHandler(r.previous);
+        r.previous = nullptr;
+        r.events.clear();
+        r.next = 0;
+        r.count = 0;
+    }
+
+    bool dumpRingBuffer(const QString& filename) {
+        Ring& r = ring();
+        QMutexLocker lock(&r.mutex);
+        if (r.events.isEmpty()) return false;
+
+        QFile f(filename);
+        if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) return false;
+
+        // oldest first
+        QTextStream out(&f);
+        const int size = r.events.size();
+        for (int i = 0; i < r.count; ++i) {
+            const Event& e = r.events.at((r.next - r.count + i + size) % size);
+            out << QString::number(e.nsecs / 1000) << "us "
+                << typeName(e.type) << ' '
+                << (e.category ? e.category : "default") << ": "
+                << e.message << '\n';
+        }
+        return true;
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <QLoggingCategory>
+#include <QString>
+
+// Tracing for hot paths. GE_TRACE_LEVEL picks what is compiled in:
+//   0 = nothing, 1 = warnings, 2 = + info, 3 = + debug.
+// Release builds (QT_NO_DEBUG) default to 1, so per-frame / per-asset
+// trace lines cost nothing there; the arguments are not even evaluated.
+#ifndef GE_TRACE_LEVEL
+#ifdef QT_NO_DEBUG
+#define GE_TRACE_LEVEL 1
+#else
+#define GE_TRACE_LEVEL 3
+#endif
+#endif
+
+Q_DECLARE_LOGGING_CATEGORY(lcResource) // ge.resource: pak / file reads, decoding
+Q_DECLARE_LOGGING_CATEGORY(lcScript)   // ge.script: script engine
+Q_DECLARE_LOGGING_CATEGORY(lcUi)       // ge.ui: input handling, widgets
+
+#if GE_TRACE_LEVEL >= 3
+#define GE_TRACE_DEBUG(cat) qCDebug(cat)
+#else
+#define GE_TRACE_DEBUG(cat) QT_NO_QDEBUG_MACRO()
+#endif
+
+#if GE_TRACE_LEVEL >= 2
+#define GE_TRACE_INFO(cat) qCInfo(cat)
+#else
+#define GE_TRACE_INFO(cat) QT_NO_QDEBUG_MACRO()
+#endif
+
+#if GE_TRACE_LEVEL >= 1
+#define GE_TRACE_WARN(cat) qCWarning(cat)
+#else
+#define GE_TRACE_WARN(cat) QT_NO_QDEBUG_MACRO()
+#endif
+
+namespace Trace {
+    // Keep the last `capacity` messages in memory instead of writing them out.
+    // With passThrough the previous message handler still sees everything;
+    // without it only warnings and worse are forwarded. The ring is dumped
+    // automatically before a qFatal.
+    void installRingBuffer(int capacity, bool passThrough = false);
+    void removeRingBuffer();
+    bool dumpRingBuffer(const QString& filename);
+}
@@ -0,0 +1,148 @@
+#include "Vfs.h"
+#include <QDir>
+#include <QRegularExpression>
+#include <algorithm>
+
+QString Vfs::normalize(const QString& path) {
+    QString p = QDir::cleanPath(QDir::fromNativeSeparators(path));
+    if (p == ".") return QString();
+    if (p.startsWith("./")) p = p.mid(2);
+    while (p.startsWith('/')) p = p.mid(1);
+    return p;
+}
+
+void Vfs::mount(const QString& mountPoint, BackendPtr backend, int priority) {
+    if (!backend) return;
+    // listing a directory tree can be slow; do it before blocking readers
+    const QStringList files = backend->files();
+
+    QWriteLocker lock(&m_lock);
+    m_mounts.push_back({ normalize(mountPoint), std::move(backend), priority, m_nextOrder++, files });
+    rebuild();
+}
+
+void Vfs::unmount(const VfsBackend* backend) {
+    QWriteLocker lock(&m_lock);
+    m_mounts.erase(std::remove_if(m_mounts.begin(), m_mounts.end(),
+        [backend](const Mount& m) { return m.backend.get() == backend; }), m_mounts.end());
+    rebuild();
+}
+
+void Vfs::refresh(const VfsBackend* backend) {
+    if (!backend) return;
+    const QStringList files = backend->files();
+
+    QWriteLocker lock(&m_lock);
+    for (Mount& m : m_mounts) {
+        if (m.backend.get() == backend) m.files = files;
+    }
+    rebuild();
+}
+
+void Vfs::rebuild() {
+    std::vector<int> order(m_mounts.size());
+    for (int i = 0; i < int(order.size()); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        const Mount& ma = m_mounts[a];
+        const Mount& mb = m_mounts[b];
+        return ma.priority != mb.priority ? ma.priority < mb.priority : ma.order < mb.order;
+    });
+
+    // lowest first, so higher priorities overwrite
+    m_files.clear();
+    for (int i : order) {
+        const Mount& m = m_mounts[i];
+        for (const QString& f : m.files) {
+            const QString path = m.point.isEmpty() ? f : m.point + '/' + f;
+            m_files.insert(path, { i, f });
+        }
+    }
+
+    m_root = Dir();
+    for (auto it = m_files.cbegin(); it != m_files.cend(); ++it) {
+        const QStringList parts = it.key().split('/', Qt::SkipEmptyParts);
+        if (parts.isEmpty()) continue;
+        Dir* dir = &m_root;
+        for (int i = 0; i < parts.size() - 1; ++i) {
+            auto& child = dir->dirs[parts[i]];
+            if (!child) child = std::make_unique<Dir>();
+            dir = child.get();
+        }
+        dir->files[parts.last()] = it.key();
+    }
+}
+
+bool Vfs::find(const QString& path, QString* backendPath, BackendPtr* backend) const {
+    // the backend is held by shared_ptr so the read can run without the lock
+    QReadLocker lock(&m_lock);
+    auto it = m_files.constFind(path);
+    if (it == m_files.constEnd()) return false;
+    *backendPath = it->backendPath;
+    *backend = m_mounts[it->mount].backend;
+    return true;
+}
+
+bool Vfs::exists(const QString& path) const {
+    QReadLocker lock(&m_lock);
+    return m_files.contains(path);
+}
+
+QByteArray Vfs::read(const QString& path) const {
+    QString backendPath;
+    BackendPtr backend;
+    return find(path, &backendPath, &backend) ? backend->read(backendPath) : QByteArray();
+}
+
+Vfs::Stat Vfs::stat(const QString& path) const {
+    QString backendPath;
+    BackendPtr backend;
+    return find(path, &backendPath, &backend) ? backend->stat(backendPath) : Stat();
+}
+
+QString Vfs::localPath(const QString& path) const {
+    QString backendPath;
+    BackendPtr backend;
+    return find(path, &backendPath, &backend) ? backend->localPath(backendPath) : QString();
+}
+
+const Vfs::Dir* Vfs::findDir(const QString& path) const {
+    const Dir* dir = &m_root;
+    for (const QString& part : path.split('/', Qt::SkipEmptyParts)) {
+        auto it = dir->dirs.find(part);
+        if (it == dir->dirs.end()) return nullptr;
+        dir = it->second.get();
+    }
+    return dir;
+}
+
+QStringList Vfs::list(const QString& dir, const QStringList& patterns, bool recursive) const {
+    QList<QRegularExpression> globs;
+    for (const QString& p : patterns) {
+        globs.append(QRegularExpression(QRegularExpression::wildcardToRegularExpression(p),
+            QRegularExpression::CaseInsensitiveOption));
+    }
+    auto matches = [&globs](const QString& name) {
+        if (globs.isEmpty()) return true;
+        for (const auto& g : globs) {
+            if (g.match(name).hasMatch()) return true;
+        }
+        return false;
+    };
+
+    QStringList result;
+    QReadLocker lock(&m_lock);
+    const Dir* start = findDir(normalize(dir));
+    if (!start) return result;
+
+    QList<const Dir*> pending{ start };
+    while (!pending.isEmpty()) {
+        const Dir* d = pending.takeLast();
+        for (const auto& f : d->files) {
+            if (matches(f.first)) result.append(f.second);
+        }
+        if (!recursive) break;
+        for (const auto& sub : d->dirs) pending.append(sub.second.get());
+    }
+    result.sort();
+    return result;
+}
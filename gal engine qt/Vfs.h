@@ -0,0 +1,95 @@
+#pragma once
+#include <QByteArray>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+#include <QStringList>
+#include <map>
+#include <memory>
+#include <vector>
+
+// A source of files for the VFS: loose directories, packages, memory.
+// Paths are relative to the backend root and '/' separated.
+// Implementations must be safe to read from any thread.
+class VfsBackend {
+public:
+    struct Stat {
+        qint64 size = -1;
+        qint64 mtime = 0; // ms since epoch; what changes when the content does
+        bool isValid() const { return size >= 0; }
+    };
+
+    virtual ~VfsBackend() = default;
+
+    // Every file the backend holds; called when it is mounted or refreshed.
+    virtual QStringList files() const = 0;
+    virtual QByteArray read(const QString& path) const = 0;
+    virtual Stat stat(const QString& path) const = 0;
+    // Host path for consumers that stream from disk; empty if not on disk.
+    virtual QString localPath(const QString& path) const {
+        Q_UNUSED(path);
+        return QString();
+    }
+};
+
+// Virtual filesystem: backends mounted at mount points, merged into one
+// file index plus a directory trie built at mount time. A path present in
+// several mounts resolves to the highest priority (later mounts win ties).
+// Lookups are a hash probe, listing walks the trie, so neither scans names.
+// Mounting rebuilds the index; reads may run on any thread meanwhile.
+class Vfs {
+public:
+    using BackendPtr = std::shared_ptr<VfsBackend>;
+    using Stat = VfsBackend::Stat;
+
+    Vfs() = default;
+    Vfs(const Vfs&) = delete;
+    Vfs& operator=(const Vfs&) = delete;
+
+    // The backend's file "x/y" appears as "<mountPoint>/x/y"; "" mounts at the root.
+    void mount(const QString& mountPoint, BackendPtr backend, int priority = 0);
+    void unmount(const VfsBackend* backend);
+    // Re-reads a mounted backend's file list after its content changed.
+    void refresh(const VfsBackend* backend);
+
+    bool exists(const QString& path) const;
+    // Null if the path is not in the VFS.
+    QByteArray read(const QString& path) const;
+    Stat stat(const QString& path) const;
+    QString localPath(const QString& path) const;
+
+    // Files in `dir` (and below it when recursive) whose file name matches
+    // one of the glob `patterns` (all files if empty). Sorted VFS paths.
+    QStringList list(const QString& dir, const QStringList& patterns = QStringList(),
+        bool recursive = false) const;
+
+    // Cleans separators, "." and ".." and strips a leading "./" or "/".
+    static QString normalize(const QString& path);
+
+private:
+    struct Mount {
+        QString point;
+        BackendPtr backend;
+        int priority = 0;
+        int order = 0;
+        QStringList files; // listed outside the lock, merged by rebuild()
+    };
+    struct File {
+        int mount = -1;
+        QString backendPath;
+    };
+    struct Dir {
+        std::map<QString, std::unique_ptr<Dir>> dirs;
+        std::map<QString, QString> files; // name -> full VFS path
+    };
+
+    void rebuild();
+    bool find(const QString& path, QString* backendPath, BackendPtr* backend) const;
+    const Dir* findDir(const QString& path) const;
+
+    mutable QReadWriteLock m_lock;
+    std::vector<Mount> m_mounts;
+    int m_nextOrder = 0;
+    QHash<QString, File> m_files;
+    Dir m_root;
+};
@@ -0,0 +1,77 @@
+#include "VfsBackends.h"
+#include "PakStack.h"
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+
+HostBackend::HostBackend(const QString& root)
+    : m_root(QDir(root).absolutePath()) {
+}
+
+QStringList HostBackend::files() const {
+    QStringList result;
+    const QDir root(m_root);
+    QDirIterator it(m_root, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) result.append(root.relativeFilePath(it.next()));
+    return result;
+}
+
+QByteArray HostBackend::read(const QString& path) const {
+    QFile f(localPath(path));
+    if (!f.open(QIODevice::ReadOnly)) return QByteArray();
+    return f.readAll();
+}
+
+VfsBackend::Stat HostBackend::stat(const QString& path) const {
+    const QFileInfo info(localPath(path));
+    if (!info.exists()) return Stat();
+    return { info.size(), info.lastModified().toMSecsSinceEpoch() };
+}
+
+QString HostBackend::localPath(const QString& path) const {
+    return m_root + '/' + path;
+}
+
+QStringList PakBackend::files() const {
+    return m_paks.entryNames();
+}
+
+QByteArray PakBackend::read(const QString& path) const {
+    return m_paks.read(path);
+}
+
+VfsBackend::Stat PakBackend::stat(const QString& path) const {
+    const PakStack::Ref ref = m_paks.resolve(path);
+    const PakArchive* pak = ref.isValid() ? m_paks.archive(ref.pak) : nullptr;
+    if (!pak) return Stat();
+    return { pak->entry(ref.index).rawSize, QFileInfo(pak->fileName()).lastModified().toMSecsSinceEpoch() };
+}
+
+void MemoryBackend::insert(const QString& path, const QByteArray& data) {
+    QWriteLocker lock(&m_lock);
+    m_files.insert(Vfs::normalize(path), { data, QDateTime::currentMSecsSinceEpoch() });
+}
+
+void MemoryBackend::remove(const QString& path) {
+    QWriteLocker lock(&m_lock);
+    m_files.remove(Vfs::normalize(path));
+}
+
+QStringList MemoryBackend::files() const {
+    QReadLocker lock(&m_lock);
+    return m_files.keys();
+}
+
+QByteArray MemoryBackend::read(const QString& path) const {
+    QReadLocker lock(&m_lock);
+    return m_files.value(path).data;
+}
+
+VfsBackend::Stat MemoryBackend::stat(const QString& path) const {
+    QReadLocker lock(&m_lock);
+    auto it = m_files.constFind(path);
+    if (it == m_files.constEnd()) return Stat();
+    return { it->data.size(), it->mtime };
+}
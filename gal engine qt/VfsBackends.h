@@ -0,0 +1,56 @@
+#pragma once
+#include <QHash>
+#include <QReadWriteLock>
+#include "Vfs.h"
+
+class PakStack;
+
+// Loose files under a host directory (the development layout).
+class HostBackend : public VfsBackend {
+public:
+    explicit HostBackend(const QString& root);
+
+    QStringList files() const override;
+    QByteArray read(const QString& path) const override;
+    Stat stat(const QString& path) const override;
+    QString localPath(const QString& path) const override;
+
+private:
+    QString m_root; // absolute
+};
+
+// Entries of the mounted packages, patches already merged by the PakStack.
+// Refresh the VFS after mounting another package into the stack.
+class PakBackend : public VfsBackend {
+public:
+    explicit PakBackend(const PakStack& paks) : m_paks(paks) {}
+
+    QStringList files() const override;
+    QByteArray read(const QString& path) const override;
+    // Entry size; the package file's mtime, since entries carry none.
+    Stat stat(const QString& path) const override;
+
+private:
+    const PakStack& m_paks;
+};
+
+// Files held in memory, e.g. generated or downloaded content.
+// Refresh the VFS after adding or removing files.
+class MemoryBackend : public VfsBackend {
+public:
+    void insert(const QString& path, const QByteArray& data);
+    void remove(const QString& path);
+
+    QStringList files() const override;
+    QByteArray read(const QString& path) const override;
+    Stat stat(const QString& path) const override;
+
+private:
+    struct File {
+        QByteArray data;
+        qint64 mtime = 0;
+    };
+
+    mutable QReadWriteLock m_lock;
+    QHash<QString, File> m_files;
+};
@@ -1,21 +1,66 @@
 #include <QApplication>
 #include <QFont>
+#include <QDir>
+#include <QFile>
 #include "StartWindow.h"
 #include "ResourceManager.h"
+#include "Trace.h"
+#include "DecodeBench.h"
 
 int main(int argc, char* argv[]) {
-
-    if (ResourceManager::USE_PACKED_RESOURCES) {
-        ResourceManager::instance().loadPackage("resources.pak");
-    }
+    // keep log lines in memory (dumped on qFatal); debug builds still print them
+#ifdef QT_NO_DEBUG
+    Trace::installRingBuffer(4096, false);
+#else
+    Trace::installRingBuffer(4096, true);
+#endif
 
     qputenv("QT_MEDIA_BACKEND", "windows");
     QApplication a(argc, argv);
 
+    const QStringList args = a.arguments();
+
+    // packed when resources.pak is present; --loose / --packed override
+    ResourceManager& rm = ResourceManager::instance();
+    const bool packed = args.contains("--packed")
+        || (!args.contains("--loose") && QFile::exists("resources.pak"));
+    if (packed) {
+        rm.loadPackage("resources.pak");
+        // patch / DLC overlays: patches/*.pak, later names win over earlier ones
+        const QDir patches("patches");
+        int priority = ResourceManager::BASE_PACKAGE_PRIORITY;
+        for (const QString& name : patches.entryList({ "*.pak" }, QDir::Files, QDir::Name)) {
+            rm.mountPackage(patches.filePath(name), ++priority);
+        }
+        // full checksum pass in the background; entries are still checked on first read without it
+        if (args.contains("--verify")) rm.verifyPackages();
+    }
+    else {
+        rm.mountDirectory("assets");
+        rm.mountDirectory("resources");
+    }
+    const int bench = args.indexOf("--bench-decode");
+    if (bench != -1) {
+        const QString image = args.value(bench + 1, DecodeBench::DEFAULT_IMAGE);
+        const int iterations = args.value(bench + 2).toInt();
+        return DecodeBench::run(image, iterations > 0 ? iterations : DecodeBench::DEFAULT_ITERATIONS);
+    }
+
     QFont font("Simhei", 18);
     a.setFont(font);
 
     StartWindow w;
     w.show();
-    return a.exec();
+    const int result = a.exec();
+
+    // ranked assets to prewarm on the next launch (cache/hotset.json)
+    rm.saveHotSet();
+
+    // per-asset load times / cache hits / stalls: --telemetry out.csv (or out.json)
+    const int telemetry = args.indexOf("--telemetry");
+    if (telemetry != -1) rm.dumpTelemetry(args.value(telemetry + 1, "telemetry.csv"));
+    // first-use order for the packer: python packer.py --order access_trace.txt
+    const int trace = args.indexOf("--access-trace");
+    if (trace != -1) rm.writeAccessTrace(args.value(trace + 1, "access_trace.txt"));
+    return result;
 }
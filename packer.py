@@ -1,35 +1,356 @@
 import os
+import re
 import zlib
 import struct
+import argparse
+import hashlib
+import pickle
+from concurrent.futures import ProcessPoolExecutor
+from functools import lru_cache
+
+try:
+    import lz4.block as lz4_block
+except ImportError:
+    lz4_block = None
+
+try:
+    import zstandard
+except ImportError:
+    zstandard = None
+
+try:
+    from PIL import Image
+except ImportError:
+    Image = None
+
+try:
+    from crc32c import crc32c as native_crc32c
+except ImportError:
+    native_crc32c = None
 
 KEY = 0x5A  # 简单异或密钥
 
+# v2 格式：头部 + 数据区 + 目录表(TOC)，运行时按需解压
+PAK_MAGIC = b"GEPK"
+PAK_VERSION = 2
+HEADER_FMT = "<4sIIIQQ"          # magic, version, headerSize, entryCount, tocOffset, tocSize
+HEADER_SIZE = struct.calcsize(HEADER_FMT)
+RECORD_FMT = "<IQQQIBBH"         # recordSize, offset, storedSize, rawSize, flags, codec, reserved, nameLen
+RECORD_SIZE = struct.calcsize(RECORD_FMT)
+
+FLAG_XOR = 0x1
+FLAG_DICTIONARY = 0x2            # zstd 字典条目，不作为资源暴露
+FLAG_TRIMMED = 0x4               # 立绘已裁掉透明边，记录名后附带原画布信息
+TRIM_FMT = "<IIii"               # canvasW, canvasH, offsetX, offsetY
+FLAG_VARIANT = 0x8               # 缩小版本，名字为 "<原路径>@<宽>x<高>"，不出现在文件列表里
+FLAG_TOMBSTONE = 0x10            # 补丁包中删除下层包的同名资源，没有数据
+FLAG_CHECKSUM = 0x20             # 记录末尾附带存储数据的 CRC32C，运行时首次读取时校验
+CHECKSUM_FMT = "<I"
+FLAG_CHUNKED = 0x40              # 数据分块独立压缩，开头是块表，运行时可按块解码、随机定位（音频流式播放）
+CHUNK_HEADER_FMT = "<II"         # chunkSize（解码后每块字节数）, chunkCount
+CHUNK_RECORD_FMT = "<II"         # 每块：存储大小, CRC32C（按存储数据计算）
+FLAG_HOT = 0x80                  # 启动时用到的条目，连续排在数据区开头，运行时一次顺序读入
+
+CODEC_STORED = 0
+CODEC_ZLIB = 1
+CODEC_LZ4 = 2                    # 解压最快，用于立绘等大图
+CODEC_ZSTD = 3                   # 小文本配合训练字典
+
+CODEC_NAMES = {"stored": CODEC_STORED, "zlib": CODEC_ZLIB, "lz4": CODEC_LZ4, "zstd": CODEC_ZSTD}
+
+# 已压缩的媒体格式：zlib 几乎无收益，--store-media 时原样存储且不加密，运行时可零拷贝映射
+MEDIA_EXTS = {".png", ".jpg", ".jpeg", ".mp3", ".ogg", ".opus", ".m4a"}
+# 大量小 JSON / 文本，适合 zstd 字典
+TEXT_EXTS = {".json", ".txt", ".qss", ".csv"}
+# 音频边播边读：超过 STREAM_MIN_SIZE 的分块存储，播放时只解码当前块
+AUDIO_EXTS = {".mp3", ".ogg", ".opus", ".m4a", ".wav", ".flac"}
+STREAM_CHUNK_SIZE = 256 * 1024
+STREAM_MIN_SIZE = 1024 * 1024
+
+# --order：按引擎记录的访问顺序（galengine --access-trace）排列条目，
+# 首次使用在 HOT_WINDOW_MS 之内的条目组成热区，总量不超过 HOT_MAX_BYTES
+HOT_WINDOW_MS = 15000
+HOT_MAX_BYTES = 64 * 1024 * 1024
+VARIANT_SUFFIX = re.compile(r"@\d+x\d+$")
+
+# --mips：为画廊等缩略显示预生成 1/2、1/4 和缩略图尺寸
+MIP_DIVISORS = (2, 4)
+MIP_THUMB_SIZE = 128             # 缩略图最长边
+
+MIN_SAVING = 0.05                # 压缩后省不到 5% 就原样存储
+LZ4_SLACK = 0.10                 # lz4 比 zlib 大不超过 10% 时优先 lz4（解压快得多）
+DICT_SIZE = 16 * 1024
+DICT_MIN_SAMPLES = 8
+ZSTD_LEVEL = 19
+DICT_NAME_PREFIX = ".dict/"
+
+# 增量打包：编码结果按 (内容哈希, 处理参数) 缓存，改了哪个文件只重做哪个
+PACK_CACHE_DIR = ".pakcache"
+PACK_CACHE_VERSION = 3           # 编码逻辑变化时递增，旧缓存自动失效
+# 缓存目录里只有这些名字是打包器写的：<sha256>.bin 及中断时残留的 <sha256>.bin.<pid>.tmp
+PACK_CACHE_FILE = re.compile(r"[0-9a-f]{64}\.bin(\.\d+\.tmp)?")
+
+# --raw-images：图片预先解码为 Qt 绘制用的像素格式，运行时不再解码 PNG
+IMAGE_EXTS = {".png", ".jpg", ".jpeg", ".bmp"}
+RAW_IMAGE_MAGIC = b"GEIM"
+RAW_IMAGE_VERSION = 1
+RAW_IMAGE_HEADER_FMT = "<4sHHIIII"   # magic, version, headerSize, width, height, format, bytesPerLine
+RAW_IMAGE_HEADER_SIZE = 32           # 补齐到 32 字节，映射时像素行保持对齐
+QIMAGE_FORMAT_RGB32 = 4
+QIMAGE_FORMAT_ARGB32_PREMULTIPLIED = 6
+
+
 def xor_encrypt(data: bytes, key: int) -> bytes:
-    return bytes([b ^ key for b in data])
+    return data.translate(bytes(b ^ key for b in range(256)))
 
-def pack_resources(base_dirs, output_file: str):
+
+def _crc32c_table():
+    table = []
+    for i in range(256):
+        c = i
+        for _ in range(8):
+            c = (c >> 1) ^ (0x82F63B78 if c & 1 else 0)
+        table.append(c)
+    return table
+
+
+CRC32C_TABLE = _crc32c_table()
+
+
+def crc32c(data: bytes) -> int:
     """
-    打包指定目录列表中的所有文件
-    保留相对路径作为资源 key
+    CRC32C (Castagnoli)，与引擎 Crc32c.cpp 一致；装了 crc32c 模块 (pip install crc32c) 时快得多
+    """
+    if native_crc32c is not None:
+        return native_crc32c(data)
+    crc = 0xFFFFFFFF
+    table = CRC32C_TABLE
+    for b in data:
+        crc = (crc >> 8) ^ table[(crc ^ b) & 0xFF]
+    return crc ^ 0xFFFFFFFF
+
+
+def checksum_field(stored: bytes) -> bytes:
+    return struct.pack(CHECKSUM_FMT, crc32c(stored))
+
+
+def compress_with(codec: int, raw: bytes, zstd_dict=None) -> bytes:
+    if codec == CODEC_STORED:
+        return raw
+    if codec == CODEC_ZLIB:
+        return zlib.compress(raw, 9)
+    if codec == CODEC_LZ4:
+        return lz4_block.compress(raw, mode="high_compression", store_size=False)
+    if codec == CODEC_ZSTD:
+        # 帧内写入原始大小和字典 id，运行时据此选择字典
+        params = {"level": ZSTD_LEVEL, "write_content_size": True, "write_dict_id": True}
+        if zstd_dict is not None:
+            params["dict_data"] = zstd_dict
+        return zstandard.ZstdCompressor(**params).compress(raw)
+    raise ValueError(f"unknown codec {codec}")
+
+
+def available_codecs():
+    codecs = [CODEC_ZLIB]
+    if lz4_block is not None:
+        codecs.append(CODEC_LZ4)
+    if zstandard is not None:
+        codecs.append(CODEC_ZSTD)
+    return codecs
+
+
+def choose_codec(rel_path: str, raw: bytes, zstd_dict=None):
+    """
+    按文件类型和实测压缩率选择编码，返回 (codec, 压缩后数据)
+    """
+    ext = os.path.splitext(rel_path)[1].lower()
+    codecs = available_codecs()
+
+    if ext in TEXT_EXTS and CODEC_ZSTD in codecs:
+        best = (CODEC_ZSTD, compress_with(CODEC_ZSTD, raw, zstd_dict))
+    else:
+        candidates = {c: compress_with(c, raw) for c in codecs if c in (CODEC_ZLIB, CODEC_LZ4)}
+        best = (CODEC_ZLIB, candidates[CODEC_ZLIB])
+        if CODEC_LZ4 in candidates and len(candidates[CODEC_LZ4]) <= len(best[1]) * (1 + LZ4_SLACK):
+            best = (CODEC_LZ4, candidates[CODEC_LZ4])
+
+    if len(best[1]) > len(raw) * (1 - MIN_SAVING):
+        return CODEC_STORED, raw
+    return best
+
+
+def transcode_raw_image(raw: bytes) -> bytes:
+    """
+    解码为预乘 ARGB32（内存中为 B,G,R,A），不透明图片标记为 RGB32
+    """
+    import io
+    img = Image.open(io.BytesIO(raw))
+    has_alpha = img.mode in ("RGBA", "LA", "PA") or (img.mode == "P" and "transparency" in img.info)
+    img = img.convert("RGBa" if has_alpha else "RGBA")  # RGBa = 预乘 alpha
+    r, g, b, a = img.split()
+    pixels = Image.merge("RGBA", (b, g, r, a)).tobytes()
+
+    width, height = img.size
+    fmt = QIMAGE_FORMAT_ARGB32_PREMULTIPLIED if has_alpha else QIMAGE_FORMAT_RGB32
+    header = struct.pack(RAW_IMAGE_HEADER_FMT, RAW_IMAGE_MAGIC, RAW_IMAGE_VERSION, RAW_IMAGE_HEADER_SIZE,
+                         width, height, fmt, width * 4)
+    return header.ljust(RAW_IMAGE_HEADER_SIZE, b"\0") + pixels
+
+
+def trim_sprite(raw: bytes):
+    """
+    裁掉完全透明的边，返回 (PNG 数据, 附加字段)；无需裁剪时返回 (原数据, b"")
+    """
+    import io
+    img = Image.open(io.BytesIO(raw))
+    if img.mode not in ("RGBA", "LA", "PA") and not (img.mode == "P" and "transparency" in img.info):
+        return raw, b""
+    img = img.convert("RGBA")
+    bbox = img.getchannel("A").getbbox()
+    if bbox is None or bbox == (0, 0) + img.size:
+        return raw, b""
+
+    buf = io.BytesIO()
+    img.crop(bbox).save(buf, "PNG", optimize=True)
+    return buf.getvalue(), struct.pack(TRIM_FMT, img.width, img.height, bbox[0], bbox[1])
+
+
+def make_mips(raw: bytes):
+    """
+    生成缩小版本，返回 [(宽, 高, PNG 数据)]，按尺寸从大到小
+    """
+    import io
+    img = Image.open(io.BytesIO(raw))
+    img.load()
+    sizes = []
+    for d in MIP_DIVISORS:
+        sizes.append((max(1, img.width // d), max(1, img.height // d)))
+    scale = MIP_THUMB_SIZE / max(img.size)
+    sizes.append((max(1, round(img.width * scale)), max(1, round(img.height * scale))))
+
+    mips = []
+    for w, h in sorted(set(sizes), reverse=True):
+        if w >= img.width or (mips and w >= mips[-1][0]):
+            continue
+        buf = io.BytesIO()
+        img.resize((w, h), Image.LANCZOS).save(buf, "PNG", optimize=True)
+        mips.append((w, h, buf.getvalue()))
+    return mips
+
+
+def encode_qoi(raw: bytes) -> bytes:
+    """
+    转成 QOI（qoiformat.org）：无损，体积接近 PNG，解码快数倍
+    """
+    import io
+    img = Image.open(io.BytesIO(raw))
+    has_alpha = img.mode in ("RGBA", "LA", "PA") or (img.mode == "P" and "transparency" in img.info)
+    img = img.convert("RGBA")
+    width, height = img.size
+    channels = 4 if has_alpha else 3
+    px_bytes = img.tobytes()
+
+    out = bytearray(b"qoif" + struct.pack(">IIBB", width, height, channels, 0))
+    index = [(0, 0, 0, 0)] * 64
+    pr, pg, pb, pa = 0, 0, 0, 255
+    run = 0
+    count = width * height
+    for i in range(count):
+        r, g, b = px_bytes[i * 4], px_bytes[i * 4 + 1], px_bytes[i * 4 + 2]
+        a = px_bytes[i * 4 + 3] if has_alpha else 255
+        if (r, g, b, a) == (pr, pg, pb, pa):
+            run += 1
+            if run == 62 or i == count - 1:
+                out.append(0xC0 | (run - 1))
+                run = 0
+            continue
+        if run:
+            out.append(0xC0 | (run - 1))
+            run = 0
+
+        h = (r * 3 + g * 5 + b * 7 + a * 11) % 64
+        if index[h] == (r, g, b, a):
+            out.append(h)
+        else:
+            index[h] = (r, g, b, a)
+            if a == pa:
+                vr = (r - pr + 128) % 256 - 128
+                vg = (g - pg + 128) % 256 - 128
+                vb = (b - pb + 128) % 256 - 128
+                vgr, vgb = vr - vg, vb - vg
+                if -3 < vr < 2 and -3 < vg < 2 and -3 < vb < 2:
+                    out.append(0x40 | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2))
+                elif -9 < vgr < 8 and -33 < vg < 32 and -9 < vgb < 8:
+                    out += bytes((0x80 | (vg + 32), (vgr + 8) << 4 | (vgb + 8)))
+                else:
+                    out += bytes((0xFE, r, g, b))
+            else:
+                out += bytes((0xFF, r, g, b, a))
+        pr, pg, pb, pa = r, g, b, a
+
+    out += b"\0" * 7 + b"\1"
+    return bytes(out)
+
+
+def train_zstd_dict(samples):
+    if zstandard is None or len(samples) < DICT_MIN_SAMPLES:
+        return None
+    try:
+        return zstandard.train_dictionary(DICT_SIZE, samples)
+    except zstandard.ZstdError as e:
+        print(f"zstd 字典训练失败，改为无字典压缩: {e}")
+        return None
+
+
+def collect_files(base_dirs, output_file: str):
+    files = []
+    for base_dir in base_dirs:
+        for root, _, filenames in os.walk(base_dir):
+            for fn in filenames:
+                full_path = os.path.join(root, fn)
+                rel_path = os.path.relpath(full_path, ".").replace("\\", "/")
+
+                # 跳过输出文件本身 & 脚本自身
+                if rel_path == output_file or rel_path.endswith(".py"):
+                    continue
+                files.append((rel_path, full_path))
+    return files
+
+
+def load_access_order(trace_files):
+    """
+    访问记录：每行 "首次使用毫秒<Tab>资源路径"，# 开头为注释。
+    多个记录按给出顺序合并，同一资源只取第一次出现
+    """
+    order, seen = [], set()
+    for trace_file in trace_files:
+        with open(trace_file, "r", encoding="utf-8") as f:
+            for line in f:
+                line = line.rstrip("\r\n")
+                if not line or line.startswith("#"):
+                    continue
+                ms, _, name = line.partition("\t")
+                name = name.replace("\\", "/").removeprefix("./")
+                if name and name not in seen:
+                    seen.add(name)
+                    order.append((int(ms), name))
+    return order
+
+
+def pack_resources_v1(base_dirs, output_file: str):
+    """
+    旧版格式：文件数 + (名字长度, 名字, 数据长度, 数据)*
+    运行时需要一次性全部解压
     """
     with open(output_file, "wb") as out:
         files = []
-        for base_dir in base_dirs:
-            for root, _, filenames in os.walk(base_dir):
-                for fn in filenames:
-                    full_path = os.path.join(root, fn)
-                    rel_path = os.path.relpath(full_path, ".").replace("\\", "/")
-
-                    # 跳过输出文件本身 & 脚本自身
-                    if rel_path == output_file or rel_path.endswith(".py"):
-                        continue
-
-                    with open(full_path, "rb") as f:
-                        raw = f.read()
-                        compressed = zlib.compress(raw)
-                        encrypted = xor_encrypt(compressed, KEY)
-                    files.append((rel_path, encrypted))
-                    print(rel_path)
+        for rel_path, full_path in collect_files(base_dirs, output_file):
+            with open(full_path, "rb") as f:
+                raw = f.read()
+                compressed = zlib.compress(raw)
+                encrypted = xor_encrypt(compressed, KEY)
+            files.append((rel_path, encrypted))
+            print(rel_path)
 
         out.write(struct.pack("<I", len(files)))
         for name, data in files:
@@ -41,6 +362,298 @@ def pack_resources(base_dirs, output_file: str):
 
     print(f"打包完成: {output_file}, 共 {len(files)} 个文件")
 
+
+def entry_options(rel_path: str, opts: dict, dict_digest: str):
+    """
+    影响某个文件处理结果的全部参数；与内容哈希一起构成缓存 key
+    """
+    ext = os.path.splitext(rel_path)[1].lower()
+    is_image = ext in IMAGE_EXTS
+    uses_dict = opts["forced"] == CODEC_ZSTD or (opts["forced"] is None and ext in TEXT_EXTS)
+    return {
+        "ext": ext,
+        "forced": opts["forced"],
+        "store_media": opts["store_media"] and ext in MEDIA_EXTS,
+        "raw_images": opts["raw_images"] if is_image else "off",
+        "raw_codec": opts["raw_codec"] if is_image else None,
+        "qoi": opts["qoi"] and is_image,
+        "trim": is_image and any(rel_path.startswith(d) for d in opts["trim_dirs"]),
+        "mips": is_image and any(rel_path.startswith(d) for d in opts["mip_dirs"]),
+        "chunk": ext in AUDIO_EXTS,
+        "dict": dict_digest if uses_dict else "",
+        "codecs": available_codecs(),
+    }
+
+
+_worker_dict = None
+
+
+def init_worker(dict_bytes):
+    global _worker_dict
+    if dict_bytes is not None:
+        _worker_dict = zstandard.ZstdCompressionDict(dict_bytes)
+
+
+def encode_chunked(codec: int, raw: bytes) -> bytes:
+    """
+    分块格式：块表头 + 每块 (存储大小, CRC32C) + 各块数据。每块单独压缩，可独立解码。
+    整体随后照常异或，CRC 按异或后的存储数据计算
+    """
+    chunks = [compress_with(codec, raw[i:i + STREAM_CHUNK_SIZE]) for i in range(0, len(raw), STREAM_CHUNK_SIZE)]
+    table = struct.pack(CHUNK_HEADER_FMT, STREAM_CHUNK_SIZE, len(chunks))
+    for chunk in chunks:
+        table += struct.pack(CHUNK_RECORD_FMT, len(chunk), crc32c(xor_encrypt(chunk, KEY)))
+    return table + b"".join(chunks)
+
+
+def encode_entry(rel_path: str, raw: bytes, eo: dict, flags: int = 0, extra: bytes = b""):
+    """
+    一个条目的编码结果：(存储数据, 原始大小, flags, codec, 附加字段, 对齐)
+    """
+    plain = False  # 原样存储且不加密，mmap 时可零拷贝
+    align = 1
+    if eo["raw_images"] != "off":
+        # 像素数据：stored 时按 32 字节对齐，运行时直接引用映射内存
+        raw = transcode_raw_image(raw)
+        if eo["raw_images"] == "stored":
+            plain, align = True, RAW_IMAGE_HEADER_SIZE
+            entry_codec, packed = CODEC_STORED, raw
+        else:
+            entry_codec, packed = eo["raw_codec"], compress_with(eo["raw_codec"], raw)
+    elif eo["qoi"]:
+        # 文件名不变，运行时按文件头识别
+        raw = encode_qoi(raw)
+        entry_codec, packed = choose_codec(rel_path, raw, _worker_dict) if eo["forced"] is None \
+            else (eo["forced"], compress_with(eo["forced"], raw, _worker_dict))
+    elif eo["store_media"]:
+        plain = True
+        entry_codec, packed = CODEC_STORED, raw
+    elif eo["forced"] is not None:
+        entry_codec, packed = eo["forced"], compress_with(eo["forced"], raw, _worker_dict)
+    else:
+        entry_codec, packed = choose_codec(rel_path, raw, _worker_dict)
+
+    if eo["chunk"] and not plain and len(raw) >= STREAM_MIN_SIZE:
+        # 编码方式按整个文件选定，各块沿用
+        packed, flags = encode_chunked(entry_codec, raw), flags | FLAG_CHUNKED
+
+    if plain:
+        stored = packed
+    else:
+        stored, flags = xor_encrypt(packed, KEY), flags | FLAG_XOR
+    # 校验和放在附加字段最后（裁边信息之后），按存储数据计算，共用数据的条目校验值相同
+    return stored, len(raw), flags | FLAG_CHECKSUM, entry_codec, extra + checksum_field(stored), align
+
+
+def build_file(job):
+    """
+    工作进程：处理一个源文件（裁边、缩小版本、转码、压缩、加密），结果写入缓存。
+    缓存条目只记名字后缀（"" 或 "@宽x高"），内容相同的文件可共用
+    """
+    cache_path, rel_path, full_path, eo = job
+    with open(full_path, "rb") as f:
+        raw = f.read()
+    entries = []
+    trim = b""
+    if eo["trim"]:
+        raw, trim = trim_sprite(raw)
+    entries.append(("",) + encode_entry(rel_path, raw, eo, FLAG_TRIMMED if trim else 0, trim))
+    if eo["mips"]:
+        for w, h, mip in make_mips(raw):
+            entries.append((f"@{w}x{h}",) + encode_entry(rel_path, mip, eo, FLAG_VARIANT))
+
+    tmp_path = f"{cache_path}.{os.getpid()}.tmp"
+    with open(tmp_path, "wb") as f:
+        pickle.dump(entries, f, protocol=pickle.HIGHEST_PROTOCOL)
+    os.replace(tmp_path, cache_path)
+    return len(entries)
+
+
+def pack_resources(base_dirs, output_file: str, store_media: bool = False, codec: str = "auto",
+                   raw_images: str = "off", qoi: bool = False, trim_dirs=None, mip_dirs=None,
+                   cache_dir: str = PACK_CACHE_DIR, jobs: int = 0, tombstones=None,
+                   order_files=None, hot_ms: int = HOT_WINDOW_MS):
+    """
+    打包指定目录列表中的所有文件
+    保留相对路径作为资源 key
+    增量：按内容哈希 + 处理参数缓存编码结果，只重新处理改动过的文件，并且多进程并行；
+    内容完全相同的条目只写一份数据，多个目录项指向同一偏移
+    tombstones：作为补丁包挂载时要从下层包删除的资源路径
+    order_files：访问记录，记录里的条目按首次使用顺序排在最前，其余仍按目录顺序
+    """
+    files = collect_files(base_dirs, output_file)
+    forced = None if codec == "auto" else CODEC_NAMES[codec]
+    if forced is not None and forced not in available_codecs() + [CODEC_STORED]:
+        raise SystemExit(f"缺少 {codec} 所需的 Python 模块 (pip install lz4 zstandard)")
+    if (raw_images != "off" or qoi or trim_dirs or mip_dirs) and Image is None:
+        raise SystemExit("--raw-images / --qoi / --trim-sprites / --mips 需要 Pillow (pip install pillow)")
+    opts = {
+        "forced": forced,
+        "store_media": store_media,
+        "raw_images": raw_images,
+        "raw_codec": CODEC_LZ4 if lz4_block is not None else CODEC_ZLIB,
+        "qoi": qoi,
+        "trim_dirs": [d.rstrip("/") + "/" for d in (trim_dirs or [])],
+        "mip_dirs": [d.rstrip("/") + "/" for d in (mip_dirs or [])],
+    }
+
+    # 先用全部文本条目训练 zstd 字典
+    zstd_dict = None
+    if forced in (None, CODEC_ZSTD):
+        samples = []
+        for rel_path, full_path in files:
+            if os.path.splitext(rel_path)[1].lower() in TEXT_EXTS:
+                with open(full_path, "rb") as f:
+                    samples.append(f.read())
+        zstd_dict = train_zstd_dict(samples)
+    dict_bytes = zstd_dict.as_bytes() if zstd_dict is not None else None
+    dict_digest = hashlib.sha256(dict_bytes).hexdigest() if dict_bytes else ""
+
+    os.makedirs(cache_dir, exist_ok=True)
+    cache_paths = []
+    misses = {}
+    for rel_path, full_path in files:
+        eo = entry_options(rel_path, opts, dict_digest)
+        key = hashlib.sha256(f"{PACK_CACHE_VERSION}|{sorted(eo.items())}|".encode("utf-8"))
+        with open(full_path, "rb") as f:
+            for chunk in iter(lambda: f.read(1 << 20), b""):
+                key.update(chunk)
+        cache_path = os.path.join(cache_dir, key.hexdigest() + ".bin")
+        if cache_path not in misses and not os.path.exists(cache_path):
+            misses[cache_path] = (cache_path, rel_path, full_path, eo)
+        cache_paths.append(cache_path)
+
+    # 改动过的文件分给所有核心并行处理
+    if misses:
+        workers = jobs or os.cpu_count() or 1
+        print(f"处理 {len(misses)} 个改动的文件（{workers} 个进程），{len(set(cache_paths)) - len(misses)} 个来自缓存")
+        if workers == 1:
+            init_worker(dict_bytes)
+            for job in misses.values():
+                build_file(job)
+        else:
+            with ProcessPoolExecutor(workers, initializer=init_worker, initargs=(dict_bytes,)) as pool:
+                for _ in pool.map(build_file, misses.values(), chunksize=4):
+                    pass
+        del misses
+
+    shared_bytes = 0
+    with open(output_file, "wb") as out:
+        out.write(b"\0" * HEADER_SIZE)  # 头部最后回填
+
+        toc = []
+        if dict_bytes is not None:
+            offset = out.tell()
+            out.write(dict_bytes)
+            toc.append((f"{DICT_NAME_PREFIX}{zstd_dict.dict_id()}", offset, len(dict_bytes), len(dict_bytes),
+                        FLAG_DICTIONARY | FLAG_CHECKSUM, CODEC_STORED, checksum_field(dict_bytes)))
+
+        blobs = {}  # (codec, 是否加密, 原始大小, 数据哈希) -> (偏移, 存储大小)
+
+        def write_entry(name, stored, raw_size, flags, entry_codec, extra, align):
+            nonlocal shared_bytes
+            blob_key = (entry_codec, flags & FLAG_XOR, raw_size, hashlib.sha256(stored).digest())
+            if blob_key in blobs:
+                offset = blobs[blob_key][0]
+                shared_bytes += len(stored)
+            else:
+                out.write(b"\0" * (-out.tell() % align))
+                offset = out.tell()
+                out.write(stored)
+                blobs[blob_key] = (offset, len(stored))
+            toc.append((name, offset, len(stored), raw_size, flags, entry_codec, extra))
+            hot = " hot" if flags & FLAG_HOT else ""
+            print(f"{name} [{next(k for k, v in CODEC_NAMES.items() if v == entry_codec)}{hot}]")
+
+        @lru_cache(maxsize=8)
+        def load_entries(cache_path):
+            with open(cache_path, "rb") as f:
+                return {e[0]: e[1:] for e in pickle.load(f)}
+
+        # 先按访问记录写入；热区必须连续，所以一旦有条目超出时间窗或预算，后面的都不再标热
+        written = set()
+        hot_bytes, hot_count, hot_open = 0, 0, True
+        cache_of = dict(zip((rel_path for rel_path, _ in files), cache_paths))
+        for ms, name in load_access_order(order_files or []):
+            rel_path = VARIANT_SUFFIX.sub("", name)
+            suffix = name[len(rel_path):]
+            if rel_path not in cache_of or suffix not in load_entries(cache_of[rel_path]):
+                continue  # 已删除的资源、存档等
+            stored, raw_size, flags, entry_codec, extra, align = load_entries(cache_of[rel_path])[suffix]
+            hot_open = hot_open and ms <= hot_ms and hot_bytes + len(stored) <= HOT_MAX_BYTES
+            if hot_open:
+                hot_bytes += len(stored)
+                hot_count += 1
+                flags |= FLAG_HOT
+            write_entry(name, stored, raw_size, flags, entry_codec, extra, align)
+            written.add(name)
+
+        for (rel_path, _), cache_path in zip(files, cache_paths):
+            for suffix, entry in load_entries(cache_path).items():
+                if rel_path + suffix not in written:
+                    write_entry(rel_path + suffix, *entry)
+
+        for name in tombstones or []:
+            name = name.replace("\\", "/").removeprefix("./")
+            toc.append((name, HEADER_SIZE, 0, 0, FLAG_TOMBSTONE, CODEC_STORED, b""))
+            print(f"{name} [deleted]")
+
+        toc_offset = out.tell()
+        for name, offset, stored_size, raw_size, flags, codec_id, extra in toc:
+            name_bytes = name.encode("utf-8")
+            out.write(struct.pack(RECORD_FMT, RECORD_SIZE + len(name_bytes) + len(extra),
+                                  offset, stored_size, raw_size, flags, codec_id, 0, len(name_bytes)))
+            out.write(name_bytes)
+            out.write(extra)
+        toc_size = out.tell() - toc_offset
+
+        out.seek(0)
+        out.write(struct.pack(HEADER_FMT, PAK_MAGIC, PAK_VERSION, HEADER_SIZE,
+                              len(toc), toc_offset, toc_size))
+
+    # 缓存只保留本次用到的结果，避免无限增长；目录可能与其他文件共用，只删自己写的
+    used = {os.path.basename(p) for p in cache_paths}
+    for fn in os.listdir(cache_dir):
+        path = os.path.join(cache_dir, fn)
+        if fn not in used and PACK_CACHE_FILE.fullmatch(fn) and os.path.isfile(path):
+            os.remove(path)
+
+    print(f"打包完成: {output_file}, 共 {len(files)} 个文件，重复内容共用 {shared_bytes} 字节")
+    if order_files:
+        print(f"热区: {hot_count} 个条目，{hot_bytes} 字节")
+
+
 if __name__ == "__main__":
-    # 只打包 assets/ 和 resources/ 目录
-    pack_resources(["assets", "resources"], "resources.pak")
+    parser = argparse.ArgumentParser(description="GalEngine resources.pak packer")
+    parser.add_argument("-o", "--output", default="resources.pak")
+    parser.add_argument("--v1", action="store_true", help="输出旧版(v1)格式")
+    parser.add_argument("--store-media", action="store_true", help="媒体文件不压缩不加密，供运行时 mmap 零拷贝读取")
+    parser.add_argument("--codec", choices=["auto"] + list(CODEC_NAMES), default="auto",
+                        help="auto=按类型与实测压缩率选择；lz4/zstd 需要 pip install lz4 zstandard")
+    images = parser.add_mutually_exclusive_group()
+    images.add_argument("--raw-images", choices=["off", "lz4", "stored"], default="off",
+                        help="图片预解码为预乘 ARGB32；stored 不压缩不加密，可配合 mmap 零拷贝")
+    images.add_argument("--qoi", action="store_true", help="图片转码为 QOI，体积接近 PNG，解码快数倍")
+    parser.add_argument("--trim-sprites", action="store_true", help="裁掉立绘的透明边，运行时按记录的偏移放置")
+    parser.add_argument("--sprite-dir", action="append", help="立绘目录，可多次指定（默认 assets/ch）")
+    parser.add_argument("--mips", action="store_true", help="为画廊图片预生成 1/2、1/4 和缩略图尺寸的版本")
+    parser.add_argument("--mip-dir", action="append", help="生成缩小版本的目录，可多次指定（默认 assets/bg 和 assets/ch）")
+    parser.add_argument("--cache-dir", default=PACK_CACHE_DIR, help="增量打包缓存目录")
+    parser.add_argument("-j", "--jobs", type=int, default=0, help="并行进程数（默认全部核心）")
+    parser.add_argument("--delete", action="append", metavar="PATH",
+                        help="补丁包：删除下层包中的该资源，可多次指定")
+    parser.add_argument("--order", action="append", metavar="TRACE",
+                        help="按访问记录（galengine --access-trace）排列条目，启动时用到的排在开头作为热区，可多次指定")
+    parser.add_argument("--hot-ms", type=int, default=HOT_WINDOW_MS,
+                        help=f"首次使用在此毫秒数之内的条目进入热区（默认 {HOT_WINDOW_MS}）")
+    parser.add_argument("dirs", nargs="*", default=["assets", "resources"])
+    args = parser.parse_args()
+
+    # 默认只打包 assets/ 和 resources/ 目录
+    if args.v1:
+        pack_resources_v1(args.dirs, args.output)
+    else:
+        pack_resources(args.dirs, args.output, args.store_media, args.codec, args.raw_images, args.qoi,
+                       (args.sprite_dir or ["assets/ch"]) if args.trim_sprites else None,
+                       (args.mip_dir or ["assets/bg", "assets/ch"]) if args.mips else None,
+                       args.cache_dir, args.jobs, args.delete, args.order, args.hot_ms)